@@ -19,57 +19,144 @@
   Data de Criacao: 05/03/2024
 */
 
+// Necessario para memmem() e outras extensoes do glibc
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <windows.h>
+#endif
+
+#ifdef __linux__
+    #include <dirent.h>
+    #include <endian.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <ifaddrs.h>
+    #include <netdb.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <pwd.h>
+    #include <regex.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <unistd.h>
+    #include <arpa/inet.h>
+    #include <net/if.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/eventfd.h>
+    #include <sys/file.h>
+    #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/sendfile.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <sys/un.h>
+    #include <sys/wait.h>
+    #include <termios.h>
+#endif
+
+#define MAX_ENDERECO 256
+#define MAX_CAMINHO 256
 
-#define MAX_IP_LENGTH 16
+// Comandos do Linux usados pelas opcoes dos menus e pelas secoes do relatorio, definidos uma unica vez.
+// O ping e limitado a 4 pacotes e 6 segundos, para terminar sozinho e devolver um codigo de saida util
+#define COMANDO_IP_LINUX "ip addr"
+#define COMANDO_PING_LINUX "ping -c 4 -w 6 %s"
+#define COMANDO_ROTA_LINUX "traceroute %s"
+#define COMANDO_MAPEAMENTOS_LINUX "df -h"
+#define COMANDO_ESTATISTICAS_LINUX "ss -tuln"
+#define COMANDO_HARDWARE_LINUX "lshw"
+#define COMANDO_DRIVERS_LINUX "lsmod"
+#define COMANDO_PROCESSOS_LINUX "ps aux"
+
+#define SNAPSHOT_MAGICO "CMDSNAP"
+#define SNAPSHOT_VERSAO 1
 
 int sistemaOperacional;
 /*---------------------------------------------------------*/
 // Prototipos das funcoes
 void verificaSistemaOperacional();
+void telaLimpa();
+void exibirMenu(const char *titulo, const char *opcoes[], const int numeros[], int numOpcoes, const char *opcaoZero);
 void printaBemVindo();
 void printaDivisao();
 void limparBuffer();
 void printaMensagem(const char *comando);
+int executarComando(const char *comando);
+int exibeSaidaDeComando(const char *comando, int argc, char *argv[]);
+void iniciaAuditoria();
+void finalizaAuditoria();
+void registraAuditoria(int acao, int evento, const char *comando, int resultado, int duracaoMs);
 int pegaOpcaoPrincipal();
 int validaOpcao(int numeroDeOpcoes);
 void menuPrincipal();
-void acessarSite();
-void acessarPasta();
-void menuDeRede();
-void verIPDaMaquina();
-void pingarEmUmPC();
-void descobrirRotaDoIP();
-void verMapeamentoDeRede();
-void verEstatisticasDeRede();
-void menuPoliticaDeGrupo();
-void atualizarPolitica();
-void verResultadoDaPolitica();
-void menuInformacoes();
-void verInformacoesDoSistema();
-void listarDrivers();
-void verListaDeProcessos();
-void menuFuncionalidadesExtras();
-void limparTela();
-void trocarCor();
-void abrirCalculadora();
-void abrirBlocoDeNotas();
-void menuJogos();
-void gerarQuestionario();
-void jogarJogoCobra();
-void menuDesligarOuReiniciar();
-void reiniciarComputador();
-void desligarComputador();
-void agendarReinicializacao();
-void agendarDesligamento();
-void cancelarAgendamento();
-void verPrevisaoDoTempo();
+int executarComandoDigitado(int argc, char *argv[]);
+int linhaDeComando(int argc, char *argv[]);
+int acessarSite(int argc, char *argv[]);
+int acessarPasta(int argc, char *argv[]);
+int verIPDaMaquina(int argc, char *argv[]);
+int pingarEmUmPC(int argc, char *argv[]);
+int descobrirRotaDoIP(int argc, char *argv[]);
+int verMapeamentoDeRede(int argc, char *argv[]);
+int verEstatisticasDeRede(int argc, char *argv[]);
+int servidorDeBanda(int argc, char *argv[]);
+int clienteDeBanda(int argc, char *argv[]);
+int atualizarPolitica(int argc, char *argv[]);
+int verResultadoDaPolitica(int argc, char *argv[]);
+int verInformacoesDoSistema(int argc, char *argv[]);
+int listarDrivers(int argc, char *argv[]);
+int verListaDeProcessos(int argc, char *argv[]);
+int filtrarProcessos(int argc, char *argv[]);
+int verSinaisVitais(int argc, char *argv[]);
+int executarAmostrador(int intervaloMs);
+int capturarSnapshot(int argc, char *argv[]);
+int compararSnapshots(int argc, char *argv[]);
+int gerarRelatorio(int argc, char *argv[]);
+int executarEmVarios(int argc, char *argv[]);
+int executarAgente(const char *caminho);
+int limparTela(int argc, char *argv[]);
+int trocarCor(int argc, char *argv[]);
+int abrirCalculadora(int argc, char *argv[]);
+int abrirBlocoDeNotas(int argc, char *argv[]);
+int gerarQuestionario(int argc, char *argv[]);
+int jogarJogoCobra(int argc, char *argv[]);
+int reiniciarComputador(int argc, char *argv[]);
+int desligarComputador(int argc, char *argv[]);
+int agendarReinicializacao(int argc, char *argv[]);
+int agendarDesligamento(int argc, char *argv[]);
+int cancelarAgendamento(int argc, char *argv[]);
+int verPrevisaoDoTempo(int argc, char *argv[]);
 /*---------------------------------------------------------*/
 // Funcao principal
-int main(){
+int main(int argc, char *argv[]){
     verificaSistemaOperacional();
+
+    if (argc > 1 && strcmp(argv[1], "--amostrador") == 0){
+        return executarAmostrador(argc > 2 ? atoi(argv[2]) : 0);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--agente") == 0){
+        return executarAgente(argc > 2 ? argv[2] : NULL);
+    }
+
+    iniciaAuditoria();
+
+    // Um comando passado na linha de comando do shell e executado sem abrir os menus
+    if (argc > 1){
+        return executarComandoDigitado(argc - 1, argv + 1) == 0 ? 0 : 1;
+    }
+
     printaBemVindo();
     menuPrincipal();
     return 0;
@@ -82,6 +169,13 @@ void verificaSistemaOperacional(){
     #elif _WIN32
         sistemaOperacional = 0;
         system("title Lista de Comandos");
+
+        // A tela e limpa e desenhada com sequencias ANSI, que o console so interpreta neste modo
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD modo;
+        if (GetConsoleMode(console, &modo)){
+            SetConsoleMode(console, modo | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
     #else
         printf("Sistema operacional nao reconhecido.\n");
     #endif
@@ -111,6 +205,255 @@ void printaMensagem(const char *comando){
     printf("\n> O comando '%s' foi executado com sucesso!\n", comando);
 }
 /*---------------------------------------------------------*/
+// Estruturas e funcoes do renderizador de tela
+//
+// O renderizador guarda dois quadros: a frente (o que ja esta no terminal) e o
+// de tras (o proximo quadro). Ao apresentar um quadro, so as celulas que mudaram
+// sao reescritas, e todas as sequencias ANSI do quadro saem em um unico write().
+// Limpar a tela e exibir menus tambem passam por aqui, sem criar processos.
+#define ATRIBUTO_NEGRITO 1
+#define ATRIBUTO_INVERTIDO 2
+
+typedef struct {
+    char caractere;
+    unsigned char atributo;
+} CelulaTela;
+
+typedef struct {
+    int linhas;
+    int colunas;
+    CelulaTela *frente;
+    CelulaTela *tras;
+    int frenteValida;
+    char *saida;
+    size_t tamanhoSaida;
+    size_t capacidadeSaida;
+} Tela;
+
+static Tela tela;
+/*---------------------------------------------------------*/
+// Acrescenta bytes ao buffer de saida do quadro atual
+static void telaAcrescenta(const char *dados, size_t tamanho){
+    if (tela.tamanhoSaida + tamanho > tela.capacidadeSaida){
+        size_t novaCapacidade = tela.capacidadeSaida ? tela.capacidadeSaida : 4096;
+        while (novaCapacidade < tela.tamanhoSaida + tamanho){
+            novaCapacidade *= 2;
+        }
+        char *novos = realloc(tela.saida, novaCapacidade);
+        if (novos == NULL){
+            return;
+        }
+        tela.saida = novos;
+        tela.capacidadeSaida = novaCapacidade;
+    }
+    memcpy(tela.saida + tela.tamanhoSaida, dados, tamanho);
+    tela.tamanhoSaida += tamanho;
+}
+/*---------------------------------------------------------*/
+// Envia todo o buffer de saida ao terminal com uma unica chamada de escrita
+static void telaEnvia(){
+    size_t enviados = 0;
+
+    // O que ja foi escrito com printf precisa aparecer antes do quadro
+    fflush(stdout);
+
+    while (enviados < tela.tamanhoSaida){
+#ifdef _WIN32
+        int escritos = _write(1, tela.saida + enviados, (unsigned int)(tela.tamanhoSaida - enviados));
+#else
+        ssize_t escritos = write(STDOUT_FILENO, tela.saida + enviados, tela.tamanhoSaida - enviados);
+        if (escritos < 0 && errno == EINTR){
+            continue;
+        }
+#endif
+        if (escritos <= 0){
+            break;
+        }
+        enviados += (size_t)escritos;
+    }
+    tela.tamanhoSaida = 0;
+}
+/*---------------------------------------------------------*/
+// Descobre o tamanho do terminal e aloca os dois quadros, refazendo-os se o terminal mudou de tamanho
+static int telaInicia(){
+    int linhas = 24;
+    int colunas = 80;
+
+#ifdef _WIN32
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    CONSOLE_SCREEN_BUFFER_INFO informacoes;
+    if (GetConsoleScreenBufferInfo(console, &informacoes)){
+        linhas = informacoes.srWindow.Bottom - informacoes.srWindow.Top + 1;
+        colunas = informacoes.srWindow.Right - informacoes.srWindow.Left + 1;
+    }
+#elif defined(__linux__)
+    struct winsize tamanho;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &tamanho) == 0 && tamanho.ws_row > 0 && tamanho.ws_col > 0){
+        linhas = tamanho.ws_row;
+        colunas = tamanho.ws_col;
+    }
+#endif
+
+    if (tela.frente != NULL && linhas == tela.linhas && colunas == tela.colunas){
+        return 0;
+    }
+
+    // Depois de um redimensionamento a frente nao corresponde mais ao terminal e o quadro e redesenhado inteiro
+    free(tela.frente);
+    free(tela.tras);
+    tela.frente = malloc((size_t)linhas * colunas * sizeof(CelulaTela));
+    tela.tras = malloc((size_t)linhas * colunas * sizeof(CelulaTela));
+    if (tela.frente == NULL || tela.tras == NULL){
+        free(tela.frente);
+        free(tela.tras);
+        tela.frente = tela.tras = NULL;
+        return -1;
+    }
+    tela.linhas = linhas;
+    tela.colunas = colunas;
+    tela.frenteValida = 0;
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Preenche um quadro inteiro com espacos
+static void telaPreenche(CelulaTela *quadro){
+    for (int i = 0; i < tela.linhas * tela.colunas; i++){
+        quadro[i].caractere = ' ';
+        quadro[i].atributo = 0;
+    }
+}
+/*---------------------------------------------------------*/
+// Limpa o quadro de tras para comecar um novo desenho
+static void telaNovoQuadro(){
+    if (telaInicia() == 0){
+        telaPreenche(tela.tras);
+    }
+}
+/*---------------------------------------------------------*/
+// Escreve um texto no quadro de tras, cortando o que passar da largura
+static void telaEscreve(int linha, int coluna, const char *texto, unsigned char atributo){
+    if (tela.tras == NULL || linha < 0 || linha >= tela.linhas){
+        return;
+    }
+    for (; *texto != '\0' && coluna < tela.colunas; texto++, coluna++){
+        if (coluna >= 0){
+            CelulaTela *celula = &tela.tras[linha * tela.colunas + coluna];
+            celula->caractere = *texto;
+            celula->atributo = atributo;
+        }
+    }
+}
+/*---------------------------------------------------------*/
+// Acrescenta a sequencia SGR correspondente ao atributo
+static void telaAcrescentaAtributo(unsigned char atributo){
+    char sequencia[16];
+    int tamanho = snprintf(sequencia, sizeof(sequencia), "\x1b[0%s%sm",
+                           (atributo & ATRIBUTO_NEGRITO) ? ";1" : "", (atributo & ATRIBUTO_INVERTIDO) ? ";7" : "");
+    telaAcrescenta(sequencia, (size_t)tamanho);
+}
+/*---------------------------------------------------------*/
+// Apresenta o quadro de tras, enviando somente as celulas diferentes da frente
+static void telaApresenta(){
+    int linhaCursor = -1;
+    int colunaCursor = -1;
+    unsigned char atributoAtual = 0;
+
+    if (tela.tras == NULL){
+        return;
+    }
+
+    if (!tela.frenteValida){
+        telaAcrescenta("\x1b[0m\x1b[2J\x1b[H", 11);
+        telaPreenche(tela.frente);
+        tela.frenteValida = 1;
+        linhaCursor = 0;
+        colunaCursor = 0;
+    }
+
+    for (int linha = 0; linha < tela.linhas; linha++){
+        for (int coluna = 0; coluna < tela.colunas; coluna++){
+            int indice = linha * tela.colunas + coluna;
+            CelulaTela *nova = &tela.tras[indice];
+            CelulaTela *antiga = &tela.frente[indice];
+
+            if (nova->caractere == antiga->caractere && nova->atributo == antiga->atributo){
+                continue;
+            }
+
+            // Para saltos curtos na mesma linha, reescrever as celulas iguais sai mais barato que mover o cursor
+            if (linha == linhaCursor && coluna > colunaCursor && coluna - colunaCursor <= 4){
+                for (int k = colunaCursor; k < coluna; k++){
+                    CelulaTela *igual = &tela.tras[linha * tela.colunas + k];
+                    if (igual->atributo != atributoAtual){
+                        telaAcrescentaAtributo(igual->atributo);
+                        atributoAtual = igual->atributo;
+                    }
+                    telaAcrescenta(&igual->caractere, 1);
+                }
+            } else if (linha != linhaCursor || coluna != colunaCursor){
+                char sequencia[24];
+                int tamanho = snprintf(sequencia, sizeof(sequencia), "\x1b[%d;%dH", linha + 1, coluna + 1);
+                telaAcrescenta(sequencia, (size_t)tamanho);
+            }
+
+            if (nova->atributo != atributoAtual){
+                telaAcrescentaAtributo(nova->atributo);
+                atributoAtual = nova->atributo;
+            }
+            telaAcrescenta(&nova->caractere, 1);
+            *antiga = *nova;
+            linhaCursor = linha;
+            colunaCursor = coluna + 1;
+
+            // Depois da ultima coluna a posicao do cursor depende do terminal
+            if (colunaCursor >= tela.colunas){
+                linhaCursor = -1;
+            }
+        }
+    }
+
+    if (atributoAtual != 0){
+        telaAcrescenta("\x1b[0m", 4);
+    }
+    telaEnvia();
+}
+/*---------------------------------------------------------*/
+// Encerra o modo de quadros, devolvendo o cursor abaixo da ultima linha usada
+static void telaFinalizaQuadros(int linhasUsadas){
+    char sequencia[32];
+    int tamanho = snprintf(sequencia, sizeof(sequencia), "\x1b[%d;1H\x1b[?25h", linhasUsadas + 1);
+
+    telaAcrescenta(sequencia, (size_t)tamanho);
+    telaEnvia();
+
+    // Daqui em diante o texto comum rola a tela e a frente deixa de refletir o terminal
+    tela.frenteValida = 0;
+}
+/*---------------------------------------------------------*/
+// Limpa a tela do terminal com sequencias ANSI, sem executar comandos externos
+void telaLimpa(){
+    telaAcrescenta("\x1b[0m\x1b[H\x1b[2J\x1b[3J", 15);
+    telaEnvia();
+    tela.frenteValida = 0;
+}
+/*---------------------------------------------------------*/
+// Exibe um menu numerado montando todo o texto e enviando-o de uma so vez; sem numeros, as opcoes vao de 1 a numOpcoes
+void exibirMenu(const char *titulo, const char *opcoes[], const int numeros[], int numOpcoes, const char *opcaoZero){
+    char linha[160];
+    int tamanho;
+
+    tamanho = snprintf(linha, sizeof(linha), "> %s:\n", titulo);
+    telaAcrescenta(linha, (size_t)tamanho);
+    for (int i = 0; i < numOpcoes; i++){
+        tamanho = snprintf(linha, sizeof(linha), "  [%d] %s\n", numeros != NULL ? numeros[i] : i + 1, opcoes[i]);
+        telaAcrescenta(linha, (size_t)tamanho);
+    }
+    tamanho = snprintf(linha, sizeof(linha), "  [0] %s\n\n> Escolha uma opcao:\n> ", opcaoZero);
+    telaAcrescenta(linha, (size_t)tamanho);
+    telaEnvia();
+    tela.frenteValida = 0;
+}
+/*---------------------------------------------------------*/
 // Obtem e valida opcao escolhida pelo usuario nos menus secundarios
 int validaOpcao(int numeroDeOpcoes){
     int resultado;
@@ -134,512 +477,5474 @@ int validaOpcao(int numeroDeOpcoes){
     return opcao;
 }
 /*---------------------------------------------------------*/
-// Obtem a opcao escolhida pelo usuario no menu principal
-int pegaOpcaoPrincipal(){
-    int opcao;
-    
-    printaDivisao();
-    printf("> Menu Principal:\n");
-    printf("  [1] Acessar um Sistema\n");
-    printf("  [2] Acessar uma Pasta na Rede\n");
-    printf("  [3] Ferramentas de Rede e Conectividade\n");
-    printf("  [4] Gerenciamento de Politicas de Grupo\n");
-    printf("  [5] Informacoes do Sistema\n");
-    printf("  [6] Funcionalidades Extras\n");
-    printf("  [7] Reiniciar/Desligar o Computador\n");
-    printf("  [0] Sair\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
-    
-    if (scanf("%d", &opcao) != 1) {
-        limparBuffer();
+// Converte o retorno do system() no codigo de saida do comando, ou -1 se ele nao terminou normalmente
+static int codigoDeSaida(int status){
+#ifdef __linux__
+    if (status == -1 || !WIFEXITED(status)){
         return -1;
     }
+    return WEXITSTATUS(status);
+#else
+    return status;
+#endif
+}
+/*---------------------------------------------------------*/
+// Executa um comando do sistema, exibe a mensagem de sucesso e retorna o codigo de saida
+int executarComando(const char *comando){
+    int retorno = codigoDeSaida(system(comando));
+    printaMensagem(comando);
+    return retorno;
+}
+/*---------------------------------------------------------*/
+// Auditoria das acoes executadas
+//
+// Cada acao executada gera um registro de tamanho fixo no inicio e outro no fim.
+// A thread do menu apenas copia o registro para um anel lock-free de um produtor
+// e um consumidor; uma thread de fundo grava os registros em lote no arquivo de
+// log (O_APPEND), faz fdatasync periodicamente e rotaciona o arquivo pelo tamanho.
+// Assim, um disco lento ou um HOME em rede nunca trava o menu. Se o anel encher,
+// os registros excedentes sao descartados e contados no proximo lote gravado.
+//
+// O arquivo padrao e ~/.comandos_auditoria.log e pode ser trocado pela variavel
+// de ambiente COMANDOS_AUDITORIA.
+#define TAMANHO_ANEL_AUDITORIA 256
+#define INTERVALO_FSYNC_AUDITORIA 1.0
+#define TAMANHO_MAXIMO_AUDITORIA (1024 * 1024)
+#define ARQUIVOS_ROTACAO_AUDITORIA 3
+#define TAMANHO_COMANDO_AUDITADO 320
 
-    return opcao;
+enum { EVENTO_INICIO = 1, EVENTO_FIM, EVENTO_SAIDA };
+
+typedef struct {
+    int64_t instante;
+    int32_t pid;
+    int32_t acao;
+    int32_t evento;
+    int32_t resultado;
+    int32_t duracaoMs;
+    char comando[TAMANHO_COMANDO_AUDITADO];
+} RegistroAuditoria;
+
+#ifdef __linux__
+static struct {
+    _Alignas(64) _Atomic uint32_t cabeca;
+    _Alignas(64) _Atomic uint32_t cauda;
+    _Alignas(64) _Atomic uint32_t descartados;
+    _Atomic int ativo;
+    RegistroAuditoria registros[TAMANHO_ANEL_AUDITORIA];
+} anelAuditoria;
+
+static pthread_t threadAuditoria;
+static int sinalAuditoria = -1;
+static int auditoriaIniciada = 0;
+static char caminhoAuditoria[512];
+static char usuarioAuditoria[64];
+/*---------------------------------------------------------*/
+// Abre o arquivo de log para acrescentar registros
+static int abreLogAuditoria(){
+    return open(caminhoAuditoria, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
 }
 /*---------------------------------------------------------*/
-// Controla o menu principal executando as opcoes escolhidas pelo usuario
-void menuPrincipal(){
-    int opcao;
-    
-    do {
-        opcao = pegaOpcaoPrincipal();
+// Rotaciona o log quando ele passa do tamanho maximo (log -> log.1 -> log.2 ...)
+//
+// Varias instancias gravam no mesmo log. A rotacao e feita com o arquivo travado,
+// e quem encontra o caminho apontando para outro arquivo (porque outra instancia
+// ja rotacionou) apenas reabre o log, sem renomear nada.
+static int rotacionaLogAuditoria(int fd){
+    struct stat info;
+    struct stat atual;
+    char origem[530];
+    char destino[530];
 
-        switch(opcao){
-            case 0:
-                break;
-            case 1:
-                acessarSite();
-                break;
-            case 2:
-                acessarPasta();
-                break;
-            case 3:
-                menuDeRede();
-                break;
-            case 4:
-                menuPoliticaDeGrupo();
-                break;
-            case 5:
-                menuInformacoes();
-                break;
-            case 6:
-                menuFuncionalidadesExtras();
-                break;
-            case 7:
-                menuDesligarOuReiniciar();
-                break;
-            case 10:
-                limparTela();
-                break;
-            case 100:
-                menuJogos();
+    if (fstat(fd, &info) != 0 || info.st_size < TAMANHO_MAXIMO_AUDITORIA){
+        return fd;
+    }
+
+    flock(fd, LOCK_EX);
+    if (stat(caminhoAuditoria, &atual) != 0 || atual.st_ino != info.st_ino || atual.st_dev != info.st_dev){
+        flock(fd, LOCK_UN);
+        close(fd);
+        return abreLogAuditoria();
+    }
+
+    for (int i = ARQUIVOS_ROTACAO_AUDITORIA - 1; i >= 1; i--){
+        snprintf(origem, sizeof(origem), "%s.%d", caminhoAuditoria, i);
+        snprintf(destino, sizeof(destino), "%s.%d", caminhoAuditoria, i + 1);
+        rename(origem, destino);
+    }
+    snprintf(destino, sizeof(destino), "%s.1", caminhoAuditoria);
+    fdatasync(fd);
+    rename(caminhoAuditoria, destino);
+    flock(fd, LOCK_UN);
+    close(fd);
+    return abreLogAuditoria();
+}
+/*---------------------------------------------------------*/
+// Formata um registro como uma linha do log
+static int formataRegistroAuditoria(const RegistroAuditoria *registro, char *linha, size_t tamanho){
+    char data[32];
+    time_t segundos = (time_t)(registro->instante / 1000);
+    struct tm utc;
+
+    gmtime_r(&segundos, &utc);
+    strftime(data, sizeof(data), "%Y-%m-%dT%H:%M:%S", &utc);
+
+    if (registro->evento == EVENTO_INICIO){
+        return snprintf(linha, tamanho, "%s.%03dZ usuario=%s pid=%d acao=%d evento=inicio comando=\"%s\"\n",
+                        data, (int)(registro->instante % 1000), usuarioAuditoria, registro->pid, registro->acao, registro->comando);
+    }
+    if (registro->evento == EVENTO_SAIDA){
+        return snprintf(linha, tamanho, "%s.%03dZ usuario=%s pid=%d acao=%d evento=saida comando=\"%s\" duracao_ms=%d\n",
+                        data, (int)(registro->instante % 1000), usuarioAuditoria, registro->pid, registro->acao, registro->comando,
+                        registro->duracaoMs);
+    }
+    return snprintf(linha, tamanho, "%s.%03dZ usuario=%s pid=%d acao=%d evento=fim comando=\"%s\" resultado=%d duracao_ms=%d\n",
+                    data, (int)(registro->instante % 1000), usuarioAuditoria, registro->pid, registro->acao, registro->comando,
+                    registro->resultado, registro->duracaoMs);
+}
+/*---------------------------------------------------------*/
+// Thread de fundo que esvazia o anel e grava os registros em lote
+static void *escritorDeAuditoria(void *argumento){
+    int fd = abreLogAuditoria();
+    char lote[16384];
+    double ultimoFsync = 0;
+    int pendenteFsync = 0;
+
+    for (;;){
+        struct pollfd espera = {sinalAuditoria, POLLIN, 0};
+        uint64_t valor;
+
+        // Quem publica durante a gravacao de um lote nao sinaliza, entao so dorme com o anel vazio
+        int pendentes = atomic_load_explicit(&anelAuditoria.cabeca, memory_order_acquire) !=
+                        atomic_load_explicit(&anelAuditoria.cauda, memory_order_relaxed);
+        poll(&espera, 1, pendentes ? 0 : 200);
+        if (espera.revents & POLLIN){
+            if (read(sinalAuditoria, &valor, sizeof(valor)) < 0){
+                valor = 0;
+            }
+        }
+        int ativo = atomic_load_explicit(&anelAuditoria.ativo, memory_order_acquire);
+
+        uint32_t cauda = atomic_load_explicit(&anelAuditoria.cauda, memory_order_relaxed);
+        uint32_t cabeca = atomic_load_explicit(&anelAuditoria.cabeca, memory_order_acquire);
+        size_t usados = 0;
+
+        uint32_t descartados = atomic_exchange_explicit(&anelAuditoria.descartados, 0, memory_order_relaxed);
+        if (descartados > 0){
+            usados += (size_t)snprintf(lote, sizeof(lote), "# %u registros descartados (anel cheio)\n", descartados);
+        }
+
+        while (cauda != cabeca){
+            char linha[512];
+            int tamanho = formataRegistroAuditoria(&anelAuditoria.registros[cauda % TAMANHO_ANEL_AUDITORIA], linha, sizeof(linha));
+            if (tamanho < 0 || (size_t)tamanho >= sizeof(linha)){
+                tamanho = 0;
+            }
+            if (usados + (size_t)tamanho > sizeof(lote)){
                 break;
-            default:
-                printf("> Opcao invalida!\n");
+            }
+            memcpy(lote + usados, linha, (size_t)tamanho);
+            usados += (size_t)tamanho;
+            cauda++;
         }
-    } while (opcao != 0);
+        atomic_store_explicit(&anelAuditoria.cauda, cauda, memory_order_release);
 
-    printf("> Programa finalizado com sucesso!\n");
-    printaDivisao();
+        if (usados > 0 && fd >= 0){
+            // Com O_APPEND cada write vai para o fim do arquivo, mesmo com varios processos gravando
+            if (write(fd, lote, usados) > 0){
+                pendenteFsync = 1;
+            }
+            fd = rotacionaLogAuditoria(fd);
+        }
+
+        double agora = (double)time(NULL);
+        if (fd >= 0 && pendenteFsync && (agora - ultimoFsync >= INTERVALO_FSYNC_AUDITORIA || !ativo)){
+            fdatasync(fd);
+            ultimoFsync = agora;
+            pendenteFsync = 0;
+        }
+
+        // So encerra depois de gravar tudo o que foi publicado antes do pedido de parada
+        if (!ativo && cauda == atomic_load_explicit(&anelAuditoria.cabeca, memory_order_acquire)){
+            break;
+        }
+    }
+
+    if (fd >= 0){
+        close(fd);
+    }
+    return NULL;
 }
+#endif
 /*---------------------------------------------------------*/
-// Acessa um site especifico usando o navegador
-void acessarSite(){
-    printaDivisao();
+// Grava os registros pendentes e encerra a thread de auditoria
+void finalizaAuditoria(){
+#ifdef __linux__
+    uint64_t um = 1;
 
-    char *urls[] = {
-        "http://intranet.cmcxs.gov.br/",
-        "https://zimbra.camaracaxias.rs.gov.br/",
-        "https://glpi.camaracaxias.rs.gov.br/",
-        "http://172.28.0.93:631/printers",
-        "https://ocs.camaracaxias.rs.gov.br/",
-        "http://ramais.cmcxs.gov.br/",
-        "https://zimbra.camaracaxias.rs.gov.br:7071/zimbraAdmin/",
-        "https://www.camaracaxias.rs.gov.br/",
-        "https://telao.cmcxs.gov.br/"
-    };
+    if (!auditoriaIniciada){
+        return;
+    }
+    auditoriaIniciada = 0;
+    atomic_store_explicit(&anelAuditoria.ativo, 0, memory_order_release);
+    if (write(sinalAuditoria, &um, sizeof(um)) < 0){
+        um = 0;
+    }
+    pthread_join(threadAuditoria, NULL);
+    close(sinalAuditoria);
+#endif
+}
+/*---------------------------------------------------------*/
+// Inicia a thread de auditoria; sem HOME ou sem thread, as acoes seguem sem registro
+void iniciaAuditoria(){
+#ifdef __linux__
+    const char *caminho = getenv("COMANDOS_AUDITORIA");
+    const char *home = getenv("HOME");
+    const char *sudo = getenv("SUDO_USER");
+    struct passwd *usuario = getpwuid(getuid());
 
-    printf("> Menu de Sistemas:\n");
-    printf("  [1] Intranet\n");
-    printf("  [2] E-mail (Zimbra)\n");
-    printf("  [3] Chamados (GLPI)\n");
-    printf("  [4] Impressoras (CUPS)\n");
-    printf("  [5] Inventario (OCS)\n");
-    printf("  [6] Ramais\n");
-    printf("  [7] Zimbra Admin\n");
-    printf("  [8] Site da Camara\n");
-    printf("  [9] Processadora de Video\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
+    if (caminho != NULL && caminho[0] != '\0'){
+        snprintf(caminhoAuditoria, sizeof(caminhoAuditoria), "%s", caminho);
+    } else if (home != NULL){
+        snprintf(caminhoAuditoria, sizeof(caminhoAuditoria), "%s/.comandos_auditoria.log", home);
+    } else {
+        return;
+    }
 
-    int opcao = validaOpcao(9);
+    // Quem usou sudo aparece junto com o usuario efetivo, como "root(joao)"
+    snprintf(usuarioAuditoria, sizeof(usuarioAuditoria), "%s%s%s%s", usuario != NULL ? usuario->pw_name : "?",
+             sudo != NULL ? "(" : "", sudo != NULL ? sudo : "", sudo != NULL ? ")" : "");
 
-    if (opcao != -1){
-        char comando[100];
+    sinalAuditoria = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (sinalAuditoria < 0){
+        return;
+    }
+    atomic_store(&anelAuditoria.ativo, 1);
+    if (pthread_create(&threadAuditoria, NULL, escritorDeAuditoria, NULL) != 0){
+        close(sinalAuditoria);
+        return;
+    }
+    auditoriaIniciada = 1;
 
-        if(sistemaOperacional){
-            sprintf(comando, "xdg-open %s > /dev/null 2>&1", urls[opcao - 1]);
-        } else {
-            sprintf(comando, "start chrome %s", urls[opcao - 1]);
+    // Acoes como reiniciar e desligar terminam com exit(), entao o log tambem e esvaziado na saida
+    atexit(finalizaAuditoria);
+#endif
+}
+/*---------------------------------------------------------*/
+// Publica um registro de auditoria sem bloquear; descarta e conta se o anel estiver cheio
+void registraAuditoria(int acao, int evento, const char *comando, int resultado, int duracaoMs){
+#ifdef __linux__
+    if (!auditoriaIniciada){
+        return;
+    }
+
+    uint32_t cabeca = atomic_load_explicit(&anelAuditoria.cabeca, memory_order_relaxed);
+    uint32_t cauda = atomic_load_explicit(&anelAuditoria.cauda, memory_order_acquire);
+
+    if (cabeca - cauda >= TAMANHO_ANEL_AUDITORIA){
+        atomic_fetch_add_explicit(&anelAuditoria.descartados, 1, memory_order_relaxed);
+        return;
+    }
+
+    RegistroAuditoria *registro = &anelAuditoria.registros[cabeca % TAMANHO_ANEL_AUDITORIA];
+    struct timespec agora;
+
+    clock_gettime(CLOCK_REALTIME, &agora);
+    registro->instante = (int64_t)agora.tv_sec * 1000 + agora.tv_nsec / 1000000;
+    registro->pid = (int32_t)getpid();
+    registro->acao = acao;
+    registro->evento = evento;
+    registro->resultado = resultado;
+    registro->duracaoMs = duracaoMs;
+
+    // Aspas e quebras de linha sao trocadas para manter uma linha por registro
+    size_t i;
+    for (i = 0; comando[i] != '\0' && i + 1 < sizeof(registro->comando); i++){
+        registro->comando[i] = (comando[i] == '"' || comando[i] == '\n' || comando[i] == '\r') ? '\'' : comando[i];
+    }
+    registro->comando[i] = '\0';
+
+    atomic_store_explicit(&anelAuditoria.cabeca, cabeca + 1, memory_order_release);
+
+    // So a passagem de vazio para nao vazio acorda o escritor; com registros pendentes ele ja vai esvazia-los
+    if (cabeca == cauda){
+        uint64_t um = 1;
+        if (write(sinalAuditoria, &um, sizeof(um)) < 0){
+            um = 0;
+        }
+    }
+#endif
+}
+/*---------------------------------------------------------*/
+// Registro de acoes
+//
+// Todas as acoes do programa sao descritas uma unica vez nesta tabela. Os menus,
+// a linha de comando digitada, a ajuda e a verificacao de sistema operacional
+// sao gerados a partir dela. Cada acao pertence a um grupo (o 'caminho') e tem
+// um nome curto, formando comandos como "rede ping 10.0.0.1".
+//
+// Os manipuladores recebem os argumentos digitados; os que nao forem informados
+// sao perguntados ao usuario, exatamente como acontece pelos menus.
+#define MAX_ARGUMENTOS_ACAO 6
+#define PLATAFORMA_LINUX 1
+#define PLATAFORMA_WINDOWS 2
+#define PLATAFORMA_TODAS (PLATAFORMA_LINUX | PLATAFORMA_WINDOWS)
+
+enum { ARGUMENTO_TEXTO = 1, ARGUMENTO_NUMERO, ARGUMENTO_ENDERECO, ARGUMENTO_RESTO };
+
+typedef struct {
+    const char *nome;
+    int tipo;
+} ArgumentoAcao;
+
+typedef struct {
+    int id;
+    const char *caminho;
+    const char *nome;
+    const char *titulo;
+    int plataformas;
+    int (*executar)(int argc, char *argv[]);
+    int atalho;
+    ArgumentoAcao argumentos[MAX_ARGUMENTOS_ACAO];
+} Acao;
+
+typedef struct {
+    const char *caminho;
+    const char *titulo;
+    const char *tituloMenu;
+    int atalho;
+} GrupoDeAcoes;
+
+// Grupos com atalho nao aparecem na lista do menu principal, mas sao aceitos pelo numero do atalho
+static const GrupoDeAcoes grupos[] = {
+    {"sistema",   "Acessar um Sistema",                  "Menu de Sistemas",                0},
+    {"pasta",     "Acessar uma Pasta na Rede",           "Menu de Pastas",                  0},
+    {"rede",      "Ferramentas de Rede e Conectividade", "Menu de Ferramentas de Rede",     0},
+    {"politica",  "Gerenciamento de Politicas de Grupo", "Menu de Politicas de Grupo",      0},
+    {"info",      "Informacoes do Sistema",              "Menu de Informacoes do Sistema",  0},
+    {"extras",    "Funcionalidades Extras",              "Menu de Funcionalidades Extras",  0},
+    {"energia",   "Reiniciar/Desligar o Computador",     "Menu Reiniciar/Desligar",         0},
+    {"relatorio", "Gerar Relatorio do Sistema",          "Menu de Relatorios",              0},
+    {"remoto",    "Executar em Varios Computadores",     "Menu de Execucao Remota",         0},
+    {"console",   "Linha de Comando",                    "Menu da Linha de Comando",        0},
+    {"jogos",     "Jogos",                               "Menu de Jogos",                   100},
+};
+
+static const Acao acoes[] = {
+    { 1, "sistema",   "abrir",         "Acessar um Sistema",                 PLATAFORMA_TODAS,   acessarSite,            0, {{"opcao", ARGUMENTO_NUMERO}}},
+    { 2, "pasta",     "abrir",         "Acessar uma Pasta na Rede",          PLATAFORMA_WINDOWS, acessarPasta,           0, {{"opcao", ARGUMENTO_NUMERO}}},
+    { 3, "rede",      "ip",            "Ver IP do Computador",               PLATAFORMA_TODAS,   verIPDaMaquina,         0, {{0}}},
+    { 4, "rede",      "ping",          "Pingar em um IP",                    PLATAFORMA_TODAS,   pingarEmUmPC,           0, {{"ip", ARGUMENTO_ENDERECO}}},
+    { 5, "rede",      "rota",          "Descobrir a Rota de um IP",          PLATAFORMA_TODAS,   descobrirRotaDoIP,      0, {{"ip", ARGUMENTO_ENDERECO}}},
+    { 6, "rede",      "mapeamentos",   "Ver Mapeamentos de Rede",            PLATAFORMA_TODAS,   verMapeamentoDeRede,    0, {{0}}},
+    { 7, "rede",      "estatisticas",  "Exibir Estatisticas de Rede",        PLATAFORMA_TODAS,   verEstatisticasDeRede,  0, {{0}}},
+    { 8, "rede",      "banda-servidor","Servidor de Teste de Banda",         PLATAFORMA_LINUX,   servidorDeBanda,        0, {{"porta", ARGUMENTO_NUMERO}}},
+    { 9, "rede",      "banda-cliente", "Cliente de Teste de Banda",          PLATAFORMA_LINUX,   clienteDeBanda,         0,
+      {{"ip", ARGUMENTO_ENDERECO}, {"porta", ARGUMENTO_NUMERO}, {"segundos", ARGUMENTO_NUMERO}, {"modo", ARGUMENTO_NUMERO},
+       {"fluxos|bytes", ARGUMENTO_NUMERO}, {"metodo", ARGUMENTO_NUMERO}}},
+    {10, "politica",  "atualizar",     "Atualizar Politica de Grupo",        PLATAFORMA_WINDOWS, atualizarPolitica,      0, {{0}}},
+    {11, "politica",  "resultado",     "Ver Resultado da Politica de Grupo", PLATAFORMA_WINDOWS, verResultadoDaPolitica, 0, {{0}}},
+    {12, "info",      "hardware",      "Informacoes do Hardware",            PLATAFORMA_TODAS,   verInformacoesDoSistema,0, {{"filtro [+N|-N]", ARGUMENTO_RESTO}}},
+    {13, "info",      "drivers",       "Listar Drivers Instalados",          PLATAFORMA_TODAS,   listarDrivers,          0, {{"filtro [+N|-N]", ARGUMENTO_RESTO}}},
+    {14, "info",      "processos",     "Listar Processos em Execucao",       PLATAFORMA_TODAS,   verListaDeProcessos,    0, {{"filtro [+N|-N]", ARGUMENTO_RESTO}}},
+    {15, "info",      "snapshot",      "Capturar Snapshot do Sistema",       PLATAFORMA_LINUX,   capturarSnapshot,       0, {{"arquivo", ARGUMENTO_TEXTO}}},
+    {16, "info",      "comparar",      "Comparar Snapshots",                 PLATAFORMA_TODAS,   compararSnapshots,      0, {{"antigo", ARGUMENTO_TEXTO}, {"novo", ARGUMENTO_TEXTO}}},
+    {17, "info",      "filtrar",       "Filtrar Processos",                  PLATAFORMA_LINUX,   filtrarProcessos,       0, {{"expressao", ARGUMENTO_RESTO}}},
+    {18, "info",      "vitais",        "Ver Sinais Vitais",                  PLATAFORMA_LINUX,   verSinaisVitais,        0, {{0}}},
+    {19, "extras",    "limpar",        "Limpar Tela",                        PLATAFORMA_TODAS,   limparTela,             10, {{0}}},
+    {20, "extras",    "cor",           "Trocar Cor",                         PLATAFORMA_WINDOWS, trocarCor,              0, {{"opcao", ARGUMENTO_NUMERO}}},
+    {21, "extras",    "previsao",      "Ver Previsao do Tempo",              PLATAFORMA_TODAS,   verPrevisaoDoTempo,     0, {{0}}},
+    {22, "extras",    "calculadora",   "Abrir a Calculadora",                PLATAFORMA_TODAS,   abrirCalculadora,       0, {{0}}},
+    {23, "extras",    "notas",         "Abrir o Bloco de Notas",             PLATAFORMA_TODAS,   abrirBlocoDeNotas,      0, {{0}}},
+    {24, "jogos",     "quiz",          "Quiz",                               PLATAFORMA_TODAS,   gerarQuestionario,      0, {{0}}},
+    {25, "jogos",     "cobra",         "Snake",                              PLATAFORMA_TODAS,   jogarJogoCobra,         0, {{0}}},
+    {26, "energia",   "reiniciar",     "Reiniciar",                          PLATAFORMA_TODAS,   reiniciarComputador,    0, {{0}}},
+    {27, "energia",   "desligar",      "Desligar",                           PLATAFORMA_TODAS,   desligarComputador,     0, {{0}}},
+    {28, "energia",   "agendar-reinicio",     "Agendar Reinicializacao",     PLATAFORMA_TODAS,   agendarReinicializacao, 0, {{"minutos", ARGUMENTO_NUMERO}}},
+    {29, "energia",   "agendar-desligamento", "Agendar Desligamento",        PLATAFORMA_TODAS,   agendarDesligamento,    0, {{"minutos", ARGUMENTO_NUMERO}}},
+    {30, "energia",   "cancelar",      "Cancelar Agendamento",               PLATAFORMA_TODAS,   cancelarAgendamento,    0, {{0}}},
+    {31, "relatorio", "gerar",         "Gerar Relatorio do Sistema",         PLATAFORMA_LINUX,   gerarRelatorio,         0, {{"ip", ARGUMENTO_ENDERECO}, {"arquivo", ARGUMENTO_TEXTO}}},
+    {32, "console",   "abrir",         "Linha de Comando",                   PLATAFORMA_TODAS,   linhaDeComando,         0, {{0}}},
+    {33, "remoto",    "executar",      "Executar em Varios Computadores",    PLATAFORMA_LINUX,   executarEmVarios,       0, {{"alvos", ARGUMENTO_TEXTO}, {"comando", ARGUMENTO_RESTO}}},
+};
+
+#define NUM_GRUPOS ((int)(sizeof(grupos) / sizeof(grupos[0])))
+#define NUM_ACOES ((int)(sizeof(acoes) / sizeof(acoes[0])))
+
+// Acao cujo manipulador esta rodando, usada para validar e auditar os valores perguntados ao usuario
+static const Acao *acaoEmExecucao = NULL;
+static char *comandoAuditado = NULL;
+static struct timespec inicioAuditado;
+/*---------------------------------------------------------*/
+// Verifica se a acao pode ser executada no sistema operacional atual
+static int acaoSuportada(const Acao *acao){
+    return (acao->plataformas & (sistemaOperacional ? PLATAFORMA_LINUX : PLATAFORMA_WINDOWS)) != 0;
+}
+/*---------------------------------------------------------*/
+// Conta os argumentos declarados no esquema da acao
+static int numArgumentosDaAcao(const Acao *acao){
+    int quantidade = 0;
+    while (quantidade < MAX_ARGUMENTOS_ACAO && acao->argumentos[quantidade].nome != NULL){
+        quantidade++;
+    }
+    return quantidade;
+}
+/*---------------------------------------------------------*/
+// Valida um argumento digitado de acordo com o tipo declarado no esquema
+static int argumentoValido(const ArgumentoAcao *argumento, const char *valor){
+    char *fim;
+
+    switch (argumento->tipo){
+        case ARGUMENTO_NUMERO:
+            strtod(valor, &fim);
+            return fim != valor && *fim == '\0';
+        case ARGUMENTO_ENDERECO:
+            if (strlen(valor) >= MAX_ENDERECO){
+                return 0;
+            }
+            for (const char *c = valor; *c != '\0'; c++){
+                if (!isalnum((unsigned char)*c) && *c != '.' && *c != ':' && *c != '-'){
+                    return 0;
+                }
+            }
+            return 1;
+        default:
+            return 1;
+    }
+}
+/*---------------------------------------------------------*/
+// Exibe a forma de uso de uma acao, como "rede ping <ip>"
+static void exibeUsoDaAcao(const Acao *acao){
+    printf("  %s %s", acao->caminho, acao->nome);
+    for (int i = 0; i < numArgumentosDaAcao(acao); i++){
+        printf(" [%s]", acao->argumentos[i].nome);
+    }
+    printf("%*s- %s%s\n", 2, "", acao->titulo, acaoSuportada(acao) ? "" : " (indisponivel neste sistema)");
+}
+/*---------------------------------------------------------*/
+// Na saida do programa no meio de uma acao (reiniciar e desligar terminam com exit()), registra o fim dela
+static int saidaAuditadaRegistrada = 0;
+
+static void registraSaidaDuranteAcao(){
+    struct timespec fim;
+
+    if (acaoEmExecucao == NULL || comandoAuditado == NULL){
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    registraAuditoria(acaoEmExecucao->id, EVENTO_SAIDA, comandoAuditado, 0,
+                      (int)((fim.tv_sec - inicioAuditado.tv_sec) * 1000 + (fim.tv_nsec - inicioAuditado.tv_nsec) / 1000000));
+    acaoEmExecucao = NULL;
+}
+/*---------------------------------------------------------*/
+// Executa uma acao do registro, verificando o sistema operacional e os argumentos informados
+int executarAcao(const Acao *acao, int argc, char *argv[]){
+    if (!acaoSuportada(acao)){
+        printaDivisao();
+        printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
+        return -1;
+    }
+
+    int numArgumentos = numArgumentosDaAcao(acao);
+    if (argc > numArgumentos){
+        printf("> Argumentos demais. Uso:\n");
+        exibeUsoDaAcao(acao);
+        return -1;
+    }
+    for (int i = 0; i < argc; i++){
+        if (!argumentoValido(&acao->argumentos[i], argv[i])){
+            printf("> Argumento invalido para '%s': '%s'\n", acao->argumentos[i].nome, argv[i]);
+            return -1;
         }
-            
-        system(comando);
-        printaMensagem(comando);
     }
+
+    // O comando auditado inclui os argumentos digitados, como "rede ping 10.0.0.1"; os perguntados entram depois
+    char comando[TAMANHO_COMANDO_AUDITADO];
+    int usados = snprintf(comando, sizeof(comando), "%s %s", acao->caminho, acao->nome);
+    for (int i = 0; i < argc && usados > 0 && (size_t)usados < sizeof(comando); i++){
+        usados += snprintf(comando + usados, sizeof(comando) - (size_t)usados, " %s", argv[i]);
+    }
+
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    registraAuditoria(acao->id, EVENTO_INICIO, comando, 0, 0);
+
+    // Os valores perguntados pelo manipulador sao validados pelo esquema desta acao e acrescentados ao comando auditado
+    const Acao *acaoAnterior = acaoEmExecucao;
+    char *comandoAnterior = comandoAuditado;
+    struct timespec inicioAnterior = inicioAuditado;
+    acaoEmExecucao = acao;
+    comandoAuditado = comando;
+    inicioAuditado = inicio;
+    if (!saidaAuditadaRegistrada){
+        atexit(registraSaidaDuranteAcao);
+        saidaAuditadaRegistrada = 1;
+    }
+
+    int resultado = acao->executar(argc, argv);
+
+    acaoEmExecucao = acaoAnterior;
+    comandoAuditado = comandoAnterior;
+    inicioAuditado = inicioAnterior;
+
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    registraAuditoria(acao->id, EVENTO_FIM, comando, resultado,
+                      (int)((fim.tv_sec - inicio.tv_sec) * 1000 + (fim.tv_nsec - inicio.tv_nsec) / 1000000));
+    return resultado;
+}
+/*---------------------------------------------------------*/
+// Acrescenta ao comando auditado um valor que o usuario digitou em uma pergunta
+static void anotaValorPerguntado(const char *valor){
+    if (comandoAuditado == NULL){
+        return;
+    }
+    size_t usados = strlen(comandoAuditado);
+    if (usados + 1 < TAMANHO_COMANDO_AUDITADO){
+        snprintf(comandoAuditado + usados, TAMANHO_COMANDO_AUDITADO - usados, " %s", valor);
+    }
+}
+/*---------------------------------------------------------*/
+// Valida um valor digitado em uma pergunta com o mesmo esquema usado para os argumentos da acao em execucao
+static int valorPerguntadoValido(int indice, const char *valor){
+    if (acaoEmExecucao == NULL || indice >= numArgumentosDaAcao(acaoEmExecucao)){
+        return 1;
+    }
+    if (!argumentoValido(&acaoEmExecucao->argumentos[indice], valor)){
+        printf("> Argumento invalido para '%s': '%s'\n", acaoEmExecucao->argumentos[indice].nome, valor);
+        return 0;
+    }
+    return 1;
+}
+/*---------------------------------------------------------*/
+// Obtem um argumento de texto da linha de comando ou, se ele nao foi informado, pergunta ao usuario
+static int obtemTexto(int argc, char *argv[], int indice, const char *mensagem, char *destino, size_t tamanho){
+    char formato[16];
+
+    if (indice < argc){
+        if (strlen(argv[indice]) >= tamanho){
+            return -1;
+        }
+        strcpy(destino, argv[indice]);
+        return 0;
+    }
+
+    printf("> %s\n", mensagem);
+    printf("> ");
+    snprintf(formato, sizeof(formato), "%%%zus", tamanho - 1);
+    if (scanf(formato, destino) != 1){
+        limparBuffer();
+        return -1;
+    }
+    if (!valorPerguntadoValido(indice, destino)){
+        return -1;
+    }
+    anotaValorPerguntado(destino);
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Obtem um argumento que pode conter espacos, lendo a linha inteira quando for perguntado
+static int obtemLinha(int argc, char *argv[], int indice, const char *mensagem, char *destino, size_t tamanho){
+    if (indice < argc){
+        return obtemTexto(argc, argv, indice, mensagem, destino, tamanho);
+    }
+
+    printf("> %s\n", mensagem);
+    printf("> ");
+
+    // Linhas vazias sao ignoradas, pois normalmente sobram da leitura da opcao do menu
+    do {
+        if (fgets(destino, (int)tamanho, stdin) == NULL){
+            return -1;
+        }
+        destino[strcspn(destino, "\r\n")] = '\0';
+    } while (destino[0] == '\0');
+    if (!valorPerguntadoValido(indice, destino)){
+        return -1;
+    }
+    anotaValorPerguntado(destino);
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Obtem um argumento numerico dentro do intervalo informado, retornando -1 se for invalido
+static int obtemNumero(int argc, char *argv[], int indice, const char *mensagem, int minimo, int maximo){
+    int valor;
+
+    if (indice < argc){
+        char *fim;
+        long convertido = strtol(argv[indice], &fim, 10);
+        if (*fim != '\0' || convertido < minimo || convertido > maximo){
+            return -1;
+        }
+        return (int)convertido;
+    }
+
+    printf("> %s\n", mensagem);
+    printf("> ");
+    if (scanf("%d", &valor) != 1){
+        limparBuffer();
+        return -1;
+    }
+    if (valor < minimo || valor > maximo){
+        return -1;
+    }
+    char texto[16];
+    snprintf(texto, sizeof(texto), "%d", valor);
+    anotaValorPerguntado(texto);
+    return valor;
+}
+/*---------------------------------------------------------*/
+// Obtem a opcao de uma lista pelo argumento ou pelo menu ja exibido, como o validaOpcao
+static int obtemOpcao(int argc, char *argv[], int indice, int numeroDeOpcoes){
+    if (indice >= argc){
+        int opcao = validaOpcao(numeroDeOpcoes);
+        if (opcao > 0){
+            char texto[16];
+            snprintf(texto, sizeof(texto), "%d", opcao);
+            anotaValorPerguntado(texto);
+        }
+        return opcao;
+    }
+
+    int opcao = obtemNumero(argc, argv, indice, NULL, 1, numeroDeOpcoes);
+    if (opcao == -1){
+        printf("> Opcao invalida!\n");
+    }
+    return opcao;
+}
+/*---------------------------------------------------------*/
+// Obtem um tempo em minutos, aceitando casas decimais
+static int obtemMinutos(int argc, char *argv[], int indice, const char *mensagem, float *minutos){
+    if (indice < argc){
+        char *fim;
+        *minutos = strtof(argv[indice], &fim);
+        return (*fim == '\0' && *minutos > 0) ? 0 : -1;
+    }
+
+    printf("> %s\n", mensagem);
+    printf("> ");
+    if (scanf("%f", minutos) != 1 || *minutos <= 0){
+        limparBuffer();
+        return -1;
+    }
+    char texto[32];
+    snprintf(texto, sizeof(texto), "%g", *minutos);
+    anotaValorPerguntado(texto);
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Exibe o menu de um grupo gerado a partir do registro e executa a acao escolhida
+void menuDoGrupo(const GrupoDeAcoes *grupo){
+    const Acao *doGrupo[NUM_ACOES];
+    const char *opcoes[NUM_ACOES];
+    int quantidade = 0;
+    int suportadas = 0;
+
+    for (int i = 0; i < NUM_ACOES; i++){
+        if (strcmp(acoes[i].caminho, grupo->caminho) == 0){
+            opcoes[quantidade] = acoes[i].titulo;
+            doGrupo[quantidade++] = &acoes[i];
+            suportadas += acaoSuportada(&acoes[i]);
+        }
+    }
+
+    if (suportadas == 0){
+        printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
+        return;
+    }
+
+    // Grupos com uma unica acao a executam diretamente, sem um menu intermediario
+    if (quantidade == 1){
+        executarAcao(doGrupo[0], 0, NULL);
+        return;
+    }
+
+    printaDivisao();
+    exibirMenu(grupo->tituloMenu, opcoes, NULL, quantidade, "Voltar");
+
+    int opcao = validaOpcao(quantidade);
+
+    if (opcao != -1){
+        executarAcao(doGrupo[opcao - 1], 0, NULL);
+    }
+}
+/*---------------------------------------------------------*/
+// Diz se o numero ja e o atalho de um grupo ou de uma acao no menu principal
+static int numeroEhAtalho(int numero){
+    for (int i = 0; i < NUM_GRUPOS; i++){
+        if (grupos[i].atalho == numero){
+            return 1;
+        }
+    }
+    for (int i = 0; i < NUM_ACOES; i++){
+        if (acoes[i].atalho == numero){
+            return 1;
+        }
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Numera os grupos visiveis na ordem do registro, pulando os numeros usados como atalho
+// (como o 10 de "Limpar Tela"), para que um grupo novo nunca tome o lugar de um atalho
+static int numeraGruposPrincipais(int numeros[], int indices[]){
+    int quantidade = 0;
+    int numero = 0;
+
+    for (int i = 0; i < NUM_GRUPOS; i++){
+        if (grupos[i].atalho != 0){
+            continue;
+        }
+        do {
+            numero++;
+        } while (numeroEhAtalho(numero));
+        numeros[quantidade] = numero;
+        indices[quantidade++] = i;
+    }
+    return quantidade;
+}
+/*---------------------------------------------------------*/
+// Obtem a opcao escolhida pelo usuario no menu principal
+int pegaOpcaoPrincipal(){
+    const char *opcoes[NUM_GRUPOS];
+    int numeros[NUM_GRUPOS];
+    int indices[NUM_GRUPOS];
+    int opcao;
+
+    int quantidade = numeraGruposPrincipais(numeros, indices);
+    for (int i = 0; i < quantidade; i++){
+        opcoes[i] = grupos[indices[i]].titulo;
+    }
+
+    printaDivisao();
+    exibirMenu("Menu Principal", opcoes, numeros, quantidade, "Sair");
+
+    if (scanf("%d", &opcao) != 1) {
+        limparBuffer();
+        return -1;
+    }
+
+    return opcao;
+}
+/*---------------------------------------------------------*/
+// Controla o menu principal executando as opcoes escolhidas pelo usuario
+void menuPrincipal(){
+    int opcao;
+
+    do {
+        opcao = pegaOpcaoPrincipal();
+
+        if (opcao == 0){
+            break;
+        }
+
+        // Os atalhos vem antes; os grupos visiveis usam os numeros exibidos no menu
+        const GrupoDeAcoes *grupo = NULL;
+        const Acao *acao = NULL;
+        int numeros[NUM_GRUPOS];
+        int indices[NUM_GRUPOS];
+
+        for (int i = 0; i < NUM_GRUPOS && grupo == NULL; i++){
+            if (grupos[i].atalho != 0 && grupos[i].atalho == opcao){
+                grupo = &grupos[i];
+            }
+        }
+        for (int i = 0; i < NUM_ACOES && grupo == NULL && acao == NULL; i++){
+            if (acoes[i].atalho != 0 && acoes[i].atalho == opcao){
+                acao = &acoes[i];
+            }
+        }
+        int quantidade = numeraGruposPrincipais(numeros, indices);
+        for (int i = 0; i < quantidade && grupo == NULL && acao == NULL; i++){
+            if (numeros[i] == opcao){
+                grupo = &grupos[indices[i]];
+            }
+        }
+
+        if (grupo != NULL){
+            menuDoGrupo(grupo);
+        } else if (acao != NULL){
+            executarAcao(acao, 0, NULL);
+        } else {
+            printf("> Opcao invalida!\n");
+        }
+    } while (opcao != 0);
+
+    printf("> Programa finalizado com sucesso!\n");
+    printaDivisao();
+}
+/*---------------------------------------------------------*/
+// Arvore de prefixos dos comandos ("grupo acao") usada na busca e no autocompletar
+//
+// Cada no guarda um caractere, o primeiro filho e o proximo irmao. Os nos que
+// terminam um comando guardam o indice da acao no registro.
+#define MAX_NOS_TRIE 2048
+
+typedef struct {
+    char caractere;
+    short primeiroFilho;
+    short proximoIrmao;
+    short acao;
+} NoTrie;
+
+static NoTrie trie[MAX_NOS_TRIE];
+static int numNosTrie = 0;
+/*---------------------------------------------------------*/
+// Retorna o filho do no com o caractere informado, ou -1
+static int filhoTrie(int no, char caractere){
+    for (int filho = trie[no].primeiroFilho; filho >= 0; filho = trie[filho].proximoIrmao){
+        if (trie[filho].caractere == caractere){
+            return filho;
+        }
+    }
+    return -1;
+}
+/*---------------------------------------------------------*/
+// Monta a arvore de prefixos com todos os comandos do registro na primeira chamada
+static void montaTrie(){
+    if (numNosTrie > 0){
+        return;
+    }
+
+    trie[0].primeiroFilho = trie[0].proximoIrmao = trie[0].acao = -1;
+    numNosTrie = 1;
+
+    for (int i = 0; i < NUM_ACOES; i++){
+        char comando[64];
+        int no = 0;
+
+        snprintf(comando, sizeof(comando), "%s %s", acoes[i].caminho, acoes[i].nome);
+        for (const char *c = comando; *c != '\0'; c++){
+            int filho = filhoTrie(no, *c);
+            if (filho < 0){
+                if (numNosTrie == MAX_NOS_TRIE){
+                    return;
+                }
+                filho = numNosTrie++;
+                trie[filho].caractere = *c;
+                trie[filho].primeiroFilho = trie[filho].acao = -1;
+                trie[filho].proximoIrmao = trie[no].primeiroFilho;
+                trie[no].primeiroFilho = (short)filho;
+            }
+            no = filho;
+        }
+        trie[no].acao = (short)i;
+    }
+}
+/*---------------------------------------------------------*/
+// Desce pela arvore seguindo o texto, retornando o no alcancado ou -1
+static int desceTrie(int no, const char *texto, size_t tamanho){
+    for (size_t i = 0; i < tamanho && no >= 0; i++){
+        no = filhoTrie(no, texto[i]);
+    }
+    return no;
+}
+/*---------------------------------------------------------*/
+// Estende um prefixo enquanto houver um unico caminho possivel, parando no separador informado
+static int estendeTrie(int no, char parada, char *saida, size_t tamanho){
+    size_t usados = strlen(saida);
+
+    while (no >= 0 && trie[no].acao < 0 && trie[no].primeiroFilho >= 0 && trie[trie[no].primeiroFilho].proximoIrmao < 0){
+        int filho = trie[no].primeiroFilho;
+        if (usados + 1 >= tamanho){
+            break;
+        }
+        saida[usados++] = trie[filho].caractere;
+        saida[usados] = '\0';
+        no = filho;
+        if (trie[no].caractere == parada){
+            break;
+        }
+    }
+    return no;
+}
+/*---------------------------------------------------------*/
+// Busca a acao de um comando, aceitando prefixos unicos para o grupo e para a acao (ex.: "re pi")
+static const Acao *buscaAcao(const char *grupo, const char *nome){
+    char completo[64] = "";
+
+    montaTrie();
+
+    int no = desceTrie(0, grupo, strlen(grupo));
+    if (no < 0){
+        return NULL;
+    }
+    if (filhoTrie(no, ' ') >= 0){
+        no = filhoTrie(no, ' ');
+    } else {
+        no = estendeTrie(no, ' ', completo, sizeof(completo));
+        if (no < 0 || trie[no].caractere != ' '){
+            return NULL;
+        }
+    }
+
+    no = desceTrie(no, nome, strlen(nome));
+    if (no >= 0 && trie[no].acao < 0){
+        completo[0] = '\0';
+        no = estendeTrie(no, '\0', completo, sizeof(completo));
+    }
+    return no >= 0 && trie[no].acao >= 0 ? &acoes[trie[no].acao] : NULL;
+}
+/*---------------------------------------------------------*/
+// Lista todos os comandos abaixo de um no da arvore
+static void listaCandidatosTrie(int no, char *prefixo, size_t tamanho, size_t profundidade){
+    if (trie[no].acao >= 0){
+        printf("  %.*s\n", (int)profundidade, prefixo);
+    }
+    for (int filho = trie[no].primeiroFilho; filho >= 0; filho = trie[filho].proximoIrmao){
+        if (profundidade + 1 < tamanho){
+            prefixo[profundidade] = trie[filho].caractere;
+            listaCandidatosTrie(filho, prefixo, tamanho, profundidade + 1);
+        }
+    }
+}
+/*---------------------------------------------------------*/
+// Completa a linha digitada com a tecla Tab, listando as opcoes quando houver mais de uma
+static void completaLinha(char *linha, size_t tamanho, size_t *usados){
+    char prefixo[64];
+
+    montaTrie();
+
+    // Somente o grupo e o nome da acao sao completados, nao os argumentos
+    const char *espaco = strchr(linha, ' ');
+    if (espaco != NULL && strchr(espaco + 1, ' ') != NULL){
+        return;
+    }
+
+    int no = desceTrie(0, linha, *usados);
+    if (no < 0){
+        return;
+    }
+
+    size_t antes = *usados;
+    no = estendeTrie(no, ' ', linha, tamanho);
+    *usados = strlen(linha);
+
+    if (*usados > antes){
+        printf("%s", linha + antes);
+    } else if (trie[no].acao >= 0 && *usados + 1 < tamanho){
+        linha[(*usados)++] = ' ';
+        linha[*usados] = '\0';
+        printf(" ");
+    } else {
+        memcpy(prefixo, linha, *usados);
+        printf("\n");
+        listaCandidatosTrie(no, prefixo, sizeof(prefixo), *usados);
+        printf("comando> %s", linha);
+    }
+    fflush(stdout);
+}
+/*---------------------------------------------------------*/
+// Le uma linha do terminal com edicao basica e autocompletar pela tecla Tab
+static int leLinhaDeComando(char *linha, size_t tamanho){
+    size_t usados = 0;
+
+    linha[0] = '\0';
+    fflush(stdout);
+
+#ifdef __linux__
+    struct termios original;
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &original) == 0){
+        struct termios bruto = original;
+        int caractere;
+
+        bruto.c_lflag &= ~(ICANON | ECHO);
+        bruto.c_cc[VMIN] = 1;
+        bruto.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &bruto);
+
+        while ((caractere = getchar()) != EOF && caractere != '\n' && caractere != '\r' && caractere != 4){
+            if (caractere == '\t'){
+                completaLinha(linha, tamanho, &usados);
+            } else if ((caractere == 127 || caractere == '\b') && usados > 0){
+                linha[--usados] = '\0';
+                printf("\b \b");
+            } else if (caractere >= ' ' && caractere < 127 && usados + 1 < tamanho){
+                linha[usados++] = (char)caractere;
+                linha[usados] = '\0';
+                putchar(caractere);
+            }
+            fflush(stdout);
+        }
+
+        tcsetattr(STDIN_FILENO, TCSANOW, &original);
+        printf("\n");
+        return (caractere == EOF || caractere == 4) && usados == 0 ? -1 : 0;
+    }
+#endif
+
+    if (fgets(linha, (int)tamanho, stdin) == NULL){
+        return -1;
+    }
+    linha[strcspn(linha, "\r\n")] = '\0';
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Separa uma linha em palavras, respeitando trechos entre aspas
+static int separaPalavras(char *linha, char *palavras[], int maximo){
+    int quantidade = 0;
+    char *leitura = linha;
+
+    while (*leitura != '\0' && quantidade < maximo){
+        while (*leitura == ' ' || *leitura == '\t'){
+            leitura++;
+        }
+        if (*leitura == '\0'){
+            break;
+        }
+
+        char fechamento = ' ';
+        if (*leitura == '"'){
+            fechamento = '"';
+            leitura++;
+        }
+        palavras[quantidade++] = leitura;
+        while (*leitura != '\0' && *leitura != fechamento && !(fechamento == ' ' && *leitura == '\t')){
+            leitura++;
+        }
+        if (*leitura != '\0'){
+            *leitura++ = '\0';
+        }
+    }
+    return quantidade;
+}
+/*---------------------------------------------------------*/
+// Exibe todos os comandos disponiveis na linha de comando
+static void exibeAjuda(){
+    printf("> Comandos disponiveis (argumentos omitidos sao perguntados):\n");
+    for (int i = 0; i < NUM_ACOES; i++){
+        exibeUsoDaAcao(&acoes[i]);
+    }
+    printf("  ajuda - Exibe esta lista\n");
+    printf("  sair  - Volta ao menu principal\n");
+}
+/*---------------------------------------------------------*/
+// Executa um comando ja separado em palavras: grupo, acao e argumentos
+int executarComandoDigitado(int argc, char *argv[]){
+    if (argc < 2){
+        printf("> Comando incompleto. Digite 'ajuda' para ver os comandos.\n");
+        return -1;
+    }
+
+    const Acao *acao = buscaAcao(argv[0], argv[1]);
+    if (acao == NULL){
+        printf("> Comando desconhecido: '%s %s'. Digite 'ajuda' para ver os comandos.\n", argv[0], argv[1]);
+        return -1;
+    }
+
+    // Um argumento do tipo 'resto' recebe todas as palavras restantes da linha
+    int numArgumentos = numArgumentosDaAcao(acao);
+    char resto[512];
+    if (numArgumentos > 0 && acao->argumentos[numArgumentos - 1].tipo == ARGUMENTO_RESTO && argc - 2 > numArgumentos){
+        resto[0] = '\0';
+        for (int i = numArgumentos + 1; i < argc; i++){
+            strncat(resto, argv[i], sizeof(resto) - strlen(resto) - 1);
+            if (i + 1 < argc){
+                strncat(resto, " ", sizeof(resto) - strlen(resto) - 1);
+            }
+        }
+        argv[numArgumentos + 1] = resto;
+        argc = numArgumentos + 2;
+    }
+
+    return executarAcao(acao, argc - 2, argv + 2);
+}
+/*---------------------------------------------------------*/
+// Abre a linha de comando digitada, onde as acoes sao executadas sem navegar pelos menus
+int linhaDeComando(int argc, char *argv[]){
+    char linha[512];
+    char *palavras[32];
+
+    printaDivisao();
+    printf("> Linha de Comando (Tab completa, 'ajuda' lista os comandos, 'sair' volta ao menu)\n");
+
+    for (;;){
+        printf("comando> ");
+        if (leLinhaDeComando(linha, sizeof(linha)) != 0){
+            break;
+        }
+
+        int quantidade = separaPalavras(linha, palavras, 32);
+        if (quantidade == 0){
+            continue;
+        }
+        if (strcmp(palavras[0], "sair") == 0 || strcmp(palavras[0], "voltar") == 0){
+            break;
+        }
+        if (strcmp(palavras[0], "ajuda") == 0){
+            exibeAjuda();
+            continue;
+        }
+        executarComandoDigitado(quantidade, palavras);
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Acessa um site especifico usando o navegador
+int acessarSite(int argc, char *argv[]){
+    printaDivisao();
+
+    char *urls[] = {
+        "http://intranet.cmcxs.gov.br/",
+        "https://zimbra.camaracaxias.rs.gov.br/",
+        "https://glpi.camaracaxias.rs.gov.br/",
+        "http://172.28.0.93:631/printers",
+        "https://ocs.camaracaxias.rs.gov.br/",
+        "http://ramais.cmcxs.gov.br/",
+        "https://zimbra.camaracaxias.rs.gov.br:7071/zimbraAdmin/",
+        "https://www.camaracaxias.rs.gov.br/",
+        "https://telao.cmcxs.gov.br/"
+    };
+
+    const char *opcoes[] = {
+        "Intranet",
+        "E-mail (Zimbra)",
+        "Chamados (GLPI)",
+        "Impressoras (CUPS)",
+        "Inventario (OCS)",
+        "Ramais",
+        "Zimbra Admin",
+        "Site da Camara",
+        "Processadora de Video"
+    };
+    if (argc == 0){
+        exibirMenu("Menu de Sistemas", opcoes, NULL, 9, "Voltar");
+    }
+
+    int opcao = obtemOpcao(argc, argv, 0, 9);
+
+    if (opcao == -1){
+        return -1;
+    }
+
+    char comando[100];
+
+    if(sistemaOperacional){
+        sprintf(comando, "xdg-open %s > /dev/null 2>&1", urls[opcao - 1]);
+    } else {
+        sprintf(comando, "start chrome %s", urls[opcao - 1]);
+    }
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Acessa uma pasta especifica da rede
+int acessarPasta(int argc, char *argv[]){
+    printaDivisao();
+
+    char *diretorios[] = {
+        "\\\\fileserver\\suporte",
+        "\\\\fileserver\\temp",
+        "\\\\fileserver\\suporte\\softwares",
+        "\\\\fileserver\\suporte\\rotinas",
+    };
+
+    const char *opcoes[] = {
+        "Suporte",
+        "Temp",
+        "Softwares",
+        "Rotinas"
+    };
+    if (argc == 0){
+        exibirMenu("Menu de Pastas", opcoes, NULL, 4, "Voltar");
+    }
+
+    int opcao = obtemOpcao(argc, argv, 0, 4);
+
+    if (opcao == -1){
+        return -1;
+    }
+
+    char comando[100];
+
+    sprintf(comando, "start %s", diretorios[opcao - 1]);
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Exibe o IP da maquina usando o comando ipconfig
+int verIPDaMaquina(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    if(sistemaOperacional){
+        strcpy(comando, COMANDO_IP_LINUX);
+    } else {
+        strcpy(comando, "ipconfig /all");
+    }
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Pinga um PC especifico usando o comando ping
+int pingarEmUmPC(int argc, char *argv[]){
+    printaDivisao();
+    char ip[MAX_ENDERECO]; 
+
+    if (obtemTexto(argc, argv, 0, "Digite o endereco IP que deseja pingar:", ip, sizeof(ip)) != 0){
+        printf("> Endereco invalido!\n");
+        return -1;
+    }
+
+    char comando[MAX_ENDERECO + 32];
+
+    if(sistemaOperacional){
+        sprintf(comando, COMANDO_PING_LINUX, ip);
+    } else {
+        sprintf(comando, "ping %s", ip);
+    }
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Rastreia a rota de um IP especifico usando o comando tracert
+int descobrirRotaDoIP(int argc, char *argv[]){
+    printaDivisao();
+    char ip[MAX_ENDERECO]; 
+
+    if (obtemTexto(argc, argv, 0, "Digite o endereco IP que deseja rastrear:", ip, sizeof(ip)) != 0){
+        printf("> Endereco invalido!\n");
+        return -1;
+    }
+
+    char comando[MAX_ENDERECO + 32];
+
+    if(sistemaOperacional){
+        sprintf(comando, COMANDO_ROTA_LINUX, ip);
+    } else {
+        sprintf(comando, "tracert %s", ip);
+    }
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Exibe os mapeamentos de rede utilizando o comando net use
+int verMapeamentoDeRede(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    if (sistemaOperacional){
+        strcpy(comando, COMANDO_MAPEAMENTOS_LINUX);
+    } else {
+        strcpy(comando, "net use");
+    }
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Exibe as estatisticas de rede utilizando o comando netstat
+int verEstatisticasDeRede(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    if (sistemaOperacional){
+        strcpy(comando, COMANDO_ESTATISTICAS_LINUX);
+    } else {
+        strcpy(comando, "netstat -s -p IP");
+    }
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Atualiza a politica de grupo utilizando o comando gpupdate
+int atualizarPolitica(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    strcpy(comando, "gpupdate /force /boot");
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Exibe o resultado da politica de grupo utilizando o comando gpresult
+int verResultadoDaPolitica(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    strcpy(comando, "gpresult /r");
+
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Exibe informacoes do sistema usando o comando systeminfo
+int verInformacoesDoSistema(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    if (sistemaOperacional){
+        strcpy(comando, COMANDO_HARDWARE_LINUX);
+    } else {
+        strcpy(comando, "systeminfo");
+    }
+
+    return exibeSaidaDeComando(comando, argc, argv);
+}
+/*---------------------------------------------------------*/
+// Lista os drivers instalados usando o comando driverquery
+int listarDrivers(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    if (sistemaOperacional){
+        strcpy(comando, COMANDO_DRIVERS_LINUX);
+    } else {
+        strcpy(comando, "driverquery");
+    }
+
+    return exibeSaidaDeComando(comando, argc, argv);
+}
+/*---------------------------------------------------------*/
+// Lista os processos em execucao usando o comando tasklist
+int verListaDeProcessos(int argc, char *argv[]){
+    printaDivisao();
+    char comando[50];
+
+    if (sistemaOperacional){
+        strcpy(comando, COMANDO_PROCESSOS_LINUX);
+    } else {
+        strcpy(comando, "tasklist");
+    }
+
+    return exibeSaidaDeComando(comando, argc, argv);
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes auxiliares do filtro de processos
+//
+// A expressao e compilada uma unica vez em uma lista de predicados (todos
+// precisam ser verdadeiros) ordenada pelo custo de avaliacao: primeiro o dono
+// do processo (um stat() no /proc), depois os campos do /proc/[pid]/stat, a
+// arvore de processos e, por ultimo, a linha de comando. Assim um processo so
+// tem o cmdline lido quando todos os testes baratos ja passaram.
+//
+// Sintaxe (termos separados por espaco):
+//   nome~texto  nome~/regex/  cmd~texto  cmd~/regex/  usuario=nome
+//   rss>2G  rss<100M  cpu>50  estado=R  ppid=1  arvore=123
+// As expressoes regulares nao podem conter espacos.
+#define MAX_PREDICADOS 16
+#define MAX_CMDLINE 4096
+
+enum { CAMPO_USUARIO, CAMPO_NOME, CAMPO_ESTADO, CAMPO_PPID, CAMPO_RSS, CAMPO_CPU, CAMPO_ARVORE, CAMPO_CMDLINE };
+enum { OPERADOR_CONTEM, OPERADOR_REGEX, OPERADOR_IGUAL, OPERADOR_MAIOR, OPERADOR_MENOR };
+
+typedef struct {
+    int campo;
+    int operador;
+    char texto[128];
+    size_t tamanhoTexto;
+    long long numero;
+#ifdef __linux__
+    regex_t regex;
+#endif
+} Predicado;
+
+typedef struct {
+    Predicado predicados[MAX_PREDICADOS];
+    int numPredicados;
+} FiltroProcessos;
+
+#ifdef __linux__
+typedef struct {
+    int pid;
+    uid_t uid;
+    char nome[64];
+    char estado;
+    int ppid;
+    long long rss;
+    double cpu;
+    unsigned long long inicio;
+    int statCarregado;
+    char cmdline[MAX_CMDLINE];
+    size_t tamanhoCmdline;
+    int cmdlineCarregado;
+} ProcessoFiltrado;
+
+typedef struct {
+    int pid;
+    int pidfd;
+    unsigned long long inicio;
+} ProcessoSelecionado;
+
+typedef struct {
+    int pid;
+    int ppid;
+} ParentescoProcesso;
+
+typedef struct {
+    ParentescoProcesso *pares;
+    size_t numPares;
+    long paginaBytes;
+    long ticksPorSegundo;
+    double tempoLigado;
+} ContextoFiltro;
+/*---------------------------------------------------------*/
+// Ordena os predicados pelo custo do campo que eles precisam ler
+static int comparaPredicados(const void *a, const void *b){
+    return ((const Predicado *)a)->campo - ((const Predicado *)b)->campo;
+}
+/*---------------------------------------------------------*/
+// Converte um tamanho como 512K, 100M ou 2G para bytes
+static long long converteTamanho(const char *texto){
+    char *fim;
+    long long valor = strtoll(texto, &fim, 10);
+
+    switch (*fim){
+        case 'k': case 'K': return valor * 1024LL;
+        case 'm': case 'M': return valor * 1024LL * 1024LL;
+        case 'g': case 'G': return valor * 1024LL * 1024LL * 1024LL;
+        default: return valor;
+    }
+}
+/*---------------------------------------------------------*/
+// Libera as expressoes regulares compiladas do filtro
+static void liberaFiltroProcessos(FiltroProcessos *filtro){
+    for (int i = 0; i < filtro->numPredicados; i++){
+        if (filtro->predicados[i].operador == OPERADOR_REGEX){
+            regfree(&filtro->predicados[i].regex);
+        }
+    }
+    filtro->numPredicados = 0;
+}
+/*---------------------------------------------------------*/
+// Compila a expressao de filtro, retornando -1 e exibindo o termo invalido em caso de erro
+static int compilaFiltroProcessos(const char *expressao, FiltroProcessos *filtro){
+    const struct { const char *nome; int campo; } campos[] = {
+        {"nome", CAMPO_NOME}, {"cmd", CAMPO_CMDLINE}, {"usuario", CAMPO_USUARIO}, {"rss", CAMPO_RSS},
+        {"cpu", CAMPO_CPU}, {"estado", CAMPO_ESTADO}, {"ppid", CAMPO_PPID}, {"arvore", CAMPO_ARVORE},
+    };
+    char copia[512];
+    char *contexto;
+
+    filtro->numPredicados = 0;
+    snprintf(copia, sizeof(copia), "%s", expressao);
+
+    for (char *termo = strtok_r(copia, " \t\n", &contexto); termo != NULL; termo = strtok_r(NULL, " \t\n", &contexto)){
+        size_t tamanhoNome = strcspn(termo, "~=<>");
+        Predicado *predicado = &filtro->predicados[filtro->numPredicados];
+        int campo = -1;
+
+        for (size_t i = 0; i < sizeof(campos) / sizeof(campos[0]); i++){
+            if (strlen(campos[i].nome) == tamanhoNome && strncmp(termo, campos[i].nome, tamanhoNome) == 0){
+                campo = campos[i].campo;
+            }
+        }
+
+        if (campo < 0 || termo[tamanhoNome] == '\0' || filtro->numPredicados == MAX_PREDICADOS){
+            printf("> Termo invalido: '%s'\n", termo);
+            liberaFiltroProcessos(filtro);
+            return -1;
+        }
+
+        char operador = termo[tamanhoNome];
+        const char *valor = termo + tamanhoNome + 1;
+        int textual = campo == CAMPO_NOME || campo == CAMPO_CMDLINE;
+
+        memset(predicado, 0, sizeof(*predicado));
+        predicado->campo = campo;
+        snprintf(predicado->texto, sizeof(predicado->texto), "%s", valor);
+        predicado->tamanhoTexto = strlen(predicado->texto);
+
+        if (textual && operador == '~'){
+            size_t tamanho = predicado->tamanhoTexto;
+            if (tamanho >= 2 && valor[0] == '/' && valor[tamanho - 1] == '/'){
+                char padrao[128];
+                snprintf(padrao, sizeof(padrao), "%.*s", (int)(tamanho - 2), valor + 1);
+                if (regcomp(&predicado->regex, padrao, REG_EXTENDED | REG_NOSUB) != 0){
+                    printf("> Expressao regular invalida: '%s'\n", padrao);
+                    liberaFiltroProcessos(filtro);
+                    return -1;
+                }
+                predicado->operador = OPERADOR_REGEX;
+            } else {
+                predicado->operador = OPERADOR_CONTEM;
+            }
+        } else if (campo == CAMPO_USUARIO && operador == '='){
+            struct passwd *usuario = getpwnam(valor);
+            predicado->operador = OPERADOR_IGUAL;
+            predicado->numero = usuario != NULL ? (long long)usuario->pw_uid : strtoll(valor, NULL, 10);
+            if (usuario == NULL && (valor[0] < '0' || valor[0] > '9')){
+                printf("> Usuario desconhecido: '%s'\n", valor);
+                liberaFiltroProcessos(filtro);
+                return -1;
+            }
+        } else if (campo == CAMPO_ESTADO && operador == '='){
+            predicado->operador = OPERADOR_IGUAL;
+        } else if ((campo == CAMPO_PPID || campo == CAMPO_ARVORE) && operador == '='){
+            predicado->operador = OPERADOR_IGUAL;
+            predicado->numero = strtoll(valor, NULL, 10);
+        } else if ((campo == CAMPO_RSS || campo == CAMPO_CPU) && (operador == '>' || operador == '<')){
+            predicado->operador = operador == '>' ? OPERADOR_MAIOR : OPERADOR_MENOR;
+            predicado->numero = campo == CAMPO_RSS ? converteTamanho(valor) : strtoll(valor, NULL, 10);
+        } else {
+            printf("> Termo invalido: '%s'\n", termo);
+            liberaFiltroProcessos(filtro);
+            return -1;
+        }
+        filtro->numPredicados++;
+    }
+
+    qsort(filtro->predicados, filtro->numPredicados, sizeof(Predicado), comparaPredicados);
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Le os campos do /proc/[pid]/stat usados pelos predicados
+static int carregaStatProcesso(ProcessoFiltrado *processo, const ContextoFiltro *contexto){
+    char caminho[64];
+    char linha[1024];
+    unsigned long tempoUsuario;
+    unsigned long tempoSistema;
+    unsigned long long inicio;
+    long paginas;
+
+    snprintf(caminho, sizeof(caminho), "/proc/%d/stat", processo->pid);
+    FILE *arquivo = fopen(caminho, "r");
+    if (arquivo == NULL){
+        return -1;
+    }
+    char *lido = fgets(linha, sizeof(linha), arquivo);
+    fclose(arquivo);
+
+    char *abre = lido != NULL ? strchr(linha, '(') : NULL;
+    char *fecha = lido != NULL ? strrchr(linha, ')') : NULL;
+    if (abre == NULL || fecha == NULL || fecha < abre){
+        return -1;
+    }
+
+    snprintf(processo->nome, sizeof(processo->nome), "%.*s", (int)(fecha - abre - 1), abre + 1);
+    if (sscanf(fecha + 2, "%c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %*d %*d %llu %*u %ld",
+               &processo->estado, &processo->ppid, &tempoUsuario, &tempoSistema, &inicio, &paginas) != 6){
+        return -1;
+    }
+
+    double vida = contexto->tempoLigado - (double)inicio / contexto->ticksPorSegundo;
+    processo->rss = (long long)paginas * contexto->paginaBytes;
+    processo->inicio = inicio;
+    processo->cpu = vida > 0 ? 100.0 * (tempoUsuario + tempoSistema) / contexto->ticksPorSegundo / vida : 0;
+    processo->statCarregado = 1;
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Confirma que o PID ainda e o mesmo processo, comparando o instante de inicio no /proc
+static int mesmoProcesso(int pid, unsigned long long inicio, const ContextoFiltro *contexto){
+    ProcessoFiltrado atual;
+
+    atual.pid = pid;
+    return carregaStatProcesso(&atual, contexto) == 0 && atual.inicio == inicio;
+}
+/*---------------------------------------------------------*/
+// Abre um pidfd para o processo selecionado, que continua apontando para ele mesmo se o PID for reutilizado
+static int abrePidfd(const ProcessoFiltrado *processo, const ContextoFiltro *contexto){
+#ifdef SYS_pidfd_open
+    int pidfd = (int)syscall(SYS_pidfd_open, processo->pid, 0);
+
+    // O processo pode ter sido trocado entre a leitura do /proc e a abertura do pidfd
+    if (pidfd >= 0 && !mesmoProcesso(processo->pid, processo->inicio, contexto)){
+        close(pidfd);
+        return -2;
+    }
+    return pidfd;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Envia o sinal pelo pidfd ou, sem ele, pelo PID depois de conferir que o processo e o mesmo
+static int enviaSinalAoProcesso(const ProcessoSelecionado *selecionado, int sinal, const ContextoFiltro *contexto){
+#ifdef SYS_pidfd_send_signal
+    if (selecionado->pidfd >= 0){
+        return (int)syscall(SYS_pidfd_send_signal, selecionado->pidfd, sinal, NULL, 0);
+    }
+#endif
+    if (!mesmoProcesso(selecionado->pid, selecionado->inicio, contexto)){
+        errno = ESRCH;
+        return -1;
+    }
+    return kill(selecionado->pid, sinal);
+}
+/*---------------------------------------------------------*/
+// Le a linha de comando do processo, trocando os separadores nulos por espacos
+static void carregaCmdlineProcesso(ProcessoFiltrado *processo){
+    char caminho[64];
+    ssize_t lidos = 0;
+
+    snprintf(caminho, sizeof(caminho), "/proc/%d/cmdline", processo->pid);
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor >= 0){
+        lidos = read(descritor, processo->cmdline, sizeof(processo->cmdline) - 1);
+        close(descritor);
+    }
+
+    if (lidos <= 0){
+        // Threads do kernel nao tem linha de comando; o ps mostra o nome entre colchetes
+        lidos = snprintf(processo->cmdline, sizeof(processo->cmdline), "[%s]", processo->nome);
+    }
+    for (ssize_t i = 0; i < lidos; i++){
+        if (processo->cmdline[i] == '\0'){
+            processo->cmdline[i] = ' ';
+        }
+    }
+    while (lidos > 0 && processo->cmdline[lidos - 1] == ' '){
+        lidos--;
+    }
+    processo->cmdline[lidos] = '\0';
+    processo->tamanhoCmdline = (size_t)lidos;
+    processo->cmdlineCarregado = 1;
+}
+/*---------------------------------------------------------*/
+// Compara dois pares pelo pid para a busca binaria do mapa de parentesco
+static int comparaParentesco(const void *a, const void *b){
+    return ((const ParentescoProcesso *)a)->pid - ((const ParentescoProcesso *)b)->pid;
+}
+/*---------------------------------------------------------*/
+// Monta o mapa pid -> ppid de todos os processos, usado pelo predicado 'arvore'
+static void carregaParentesco(ContextoFiltro *contexto){
+    DIR *diretorio = opendir("/proc");
+    struct dirent *entrada;
+    size_t capacidade = 0;
+
+    if (diretorio == NULL){
+        return;
+    }
+
+    while ((entrada = readdir(diretorio)) != NULL){
+        ProcessoFiltrado processo;
+
+        if (entrada->d_name[0] < '0' || entrada->d_name[0] > '9'){
+            continue;
+        }
+        processo.pid = atoi(entrada->d_name);
+        if (carregaStatProcesso(&processo, contexto) != 0){
+            continue;
+        }
+
+        if (contexto->numPares == capacidade){
+            capacidade = capacidade ? capacidade * 2 : 512;
+            ParentescoProcesso *novos = realloc(contexto->pares, capacidade * sizeof(ParentescoProcesso));
+            if (novos == NULL){
+                break;
+            }
+            contexto->pares = novos;
+        }
+        contexto->pares[contexto->numPares].pid = processo.pid;
+        contexto->pares[contexto->numPares].ppid = processo.ppid;
+        contexto->numPares++;
+    }
+    closedir(diretorio);
+
+    qsort(contexto->pares, contexto->numPares, sizeof(ParentescoProcesso), comparaParentesco);
+}
+/*---------------------------------------------------------*/
+// Verifica se o processo e o proprio ancestral ou um descendente dele
+static int descendeDe(const ContextoFiltro *contexto, int pid, int ancestral){
+    // O limite de passos evita lacos caso o mapa esteja inconsistente
+    for (int passos = 0; pid > 0 && passos < 4096; passos++){
+        if (pid == ancestral){
+            return 1;
+        }
+        ParentescoProcesso chave = {pid, 0};
+        ParentescoProcesso *par = bsearch(&chave, contexto->pares, contexto->numPares, sizeof(ParentescoProcesso), comparaParentesco);
+        if (par == NULL){
+            return 0;
+        }
+        pid = par->ppid;
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Avalia um predicado textual (substring com memmem ou expressao regular)
+static int avaliaTexto(const Predicado *predicado, const char *texto, size_t tamanho){
+    if (predicado->operador == OPERADOR_REGEX){
+        return regexec(&predicado->regex, texto, 0, NULL, 0) == 0;
+    }
+    return memmem(texto, tamanho, predicado->texto, predicado->tamanhoTexto) != NULL;
+}
+/*---------------------------------------------------------*/
+// Avalia um predicado numerico
+static int avaliaNumero(const Predicado *predicado, double valor){
+    switch (predicado->operador){
+        case OPERADOR_MAIOR: return valor > predicado->numero;
+        case OPERADOR_MENOR: return valor < predicado->numero;
+        default: return valor == predicado->numero;
+    }
+}
+/*---------------------------------------------------------*/
+// Avalia todos os predicados em ordem de custo, carregando os dados so quando necessario
+static int processoAtendeFiltro(const FiltroProcessos *filtro, const ContextoFiltro *contexto, ProcessoFiltrado *processo){
+    for (int i = 0; i < filtro->numPredicados; i++){
+        const Predicado *predicado = &filtro->predicados[i];
+
+        if (predicado->campo != CAMPO_USUARIO && predicado->campo != CAMPO_ARVORE && !processo->statCarregado){
+            if (carregaStatProcesso(processo, contexto) != 0){
+                return 0;
+            }
+        }
+
+        int atende = 0;
+        switch (predicado->campo){
+            case CAMPO_USUARIO: atende = avaliaNumero(predicado, processo->uid); break;
+            case CAMPO_NOME:    atende = avaliaTexto(predicado, processo->nome, strlen(processo->nome)); break;
+            case CAMPO_ESTADO:  atende = strchr(predicado->texto, processo->estado) != NULL; break;
+            case CAMPO_PPID:    atende = avaliaNumero(predicado, processo->ppid); break;
+            case CAMPO_RSS:     atende = avaliaNumero(predicado, (double)processo->rss); break;
+            case CAMPO_CPU:     atende = avaliaNumero(predicado, processo->cpu); break;
+            case CAMPO_ARVORE:  atende = descendeDe(contexto, processo->pid, (int)predicado->numero); break;
+            case CAMPO_CMDLINE:
+                if (!processo->cmdlineCarregado){
+                    carregaCmdlineProcesso(processo);
+                }
+                atende = avaliaTexto(predicado, processo->cmdline, processo->tamanhoCmdline);
+                break;
+        }
+        if (!atende){
+            return 0;
+        }
+    }
+    return 1;
+}
+#endif
+/*---------------------------------------------------------*/
+// Lista apenas os processos que atendem a uma expressao de filtro e permite sinaliza-los
+int filtrarProcessos(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    char expressao[512];
+    FiltroProcessos filtro;
+    ContextoFiltro contexto = {0};
+    ProcessoSelecionado *encontrados = NULL;
+    size_t numEncontrados = 0;
+    size_t capacidade = 0;
+
+    if (obtemLinha(argc, argv, 0, "Digite o filtro (ex.: nome~java rss>2G usuario=root cpu>10 estado=R ppid=1 arvore=1 cmd~/regex/):",
+                   expressao, sizeof(expressao)) != 0 || compilaFiltroProcessos(expressao, &filtro) != 0){
+        printf("> Filtro invalido!\n");
+        return -1;
+    }
+
+    FILE *uptime = fopen("/proc/uptime", "r");
+    if (uptime != NULL){
+        if (fscanf(uptime, "%lf", &contexto.tempoLigado) != 1){
+            contexto.tempoLigado = 0;
+        }
+        fclose(uptime);
+    }
+    contexto.paginaBytes = sysconf(_SC_PAGESIZE);
+    contexto.ticksPorSegundo = sysconf(_SC_CLK_TCK);
+
+    for (int i = 0; i < filtro.numPredicados; i++){
+        if (filtro.predicados[i].campo == CAMPO_ARVORE){
+            carregaParentesco(&contexto);
+            break;
+        }
+    }
+
+    DIR *diretorio = opendir("/proc");
+    struct dirent *entrada;
+    if (diretorio == NULL){
+        liberaFiltroProcessos(&filtro);
+        free(contexto.pares);
+        return -1;
+    }
+
+    printf("%7s %7s %-10s %s %10s %6s  %s\n", "PID", "PPID", "USUARIO", "E", "RSS(KB)", "CPU%", "COMANDO");
+
+    while ((entrada = readdir(diretorio)) != NULL){
+        ProcessoFiltrado processo;
+        char caminho[64];
+        struct stat informacoes;
+
+        if (entrada->d_name[0] < '0' || entrada->d_name[0] > '9'){
+            continue;
+        }
+
+        processo.pid = atoi(entrada->d_name);
+        processo.statCarregado = 0;
+        processo.cmdlineCarregado = 0;
+        snprintf(caminho, sizeof(caminho), "/proc/%d", processo.pid);
+        if (stat(caminho, &informacoes) != 0){
+            continue;
+        }
+        processo.uid = informacoes.st_uid;
+
+        if (!processoAtendeFiltro(&filtro, &contexto, &processo)){
+            continue;
+        }
+
+        // Somente os processos selecionados sao lidos por completo
+        if (!processo.statCarregado && carregaStatProcesso(&processo, &contexto) != 0){
+            continue;
+        }
+        if (!processo.cmdlineCarregado){
+            carregaCmdlineProcesso(&processo);
+        }
+
+        // O pidfd e aberto ja na selecao, para que o sinal nunca atinja um processo que reutilizou o PID
+        int pidfd = abrePidfd(&processo, &contexto);
+        if (pidfd == -2){
+            continue;
+        }
+
+        struct passwd *usuario = getpwuid(processo.uid);
+        char nomeUsuario[16];
+        if (usuario != NULL){
+            snprintf(nomeUsuario, sizeof(nomeUsuario), "%.10s", usuario->pw_name);
+        } else {
+            snprintf(nomeUsuario, sizeof(nomeUsuario), "%u", (unsigned)processo.uid);
+        }
+
+        printf("%7d %7d %-10s %c %10lld %6.1f  %s\n", processo.pid, processo.ppid, nomeUsuario, processo.estado,
+               processo.rss / 1024, processo.cpu, processo.cmdline);
+
+        if (numEncontrados == capacidade){
+            capacidade = capacidade ? capacidade * 2 : 64;
+            ProcessoSelecionado *novos = realloc(encontrados, capacidade * sizeof(ProcessoSelecionado));
+            if (novos == NULL){
+                if (pidfd >= 0){
+                    close(pidfd);
+                }
+                break;
+            }
+            encontrados = novos;
+        }
+        encontrados[numEncontrados].pid = processo.pid;
+        encontrados[numEncontrados].pidfd = pidfd;
+        encontrados[numEncontrados++].inicio = processo.inicio;
+    }
+    closedir(diretorio);
+    liberaFiltroProcessos(&filtro);
+
+    printf("\n> %zu processos encontrados.\n", numEncontrados);
+
+    if (numEncontrados > 0){
+        int sinal;
+
+        printf("> Deseja enviar um sinal a esses processos? (0-Nao, ou o numero do sinal, ex.: 15-TERM, 9-KILL)\n");
+        printf("> ");
+
+        if (scanf("%d", &sinal) != 1){
+            limparBuffer();
+            printf("> Opcao invalida!\n");
+        } else if (sinal > 0 && sinal < NSIG){
+            size_t falhas = 0;
+            for (size_t i = 0; i < numEncontrados; i++){
+                if (encontrados[i].pid != getpid() && enviaSinalAoProcesso(&encontrados[i], sinal, &contexto) != 0){
+                    falhas++;
+                }
+            }
+            printf("> Sinal %d enviado a %zu processos (%zu falhas)!\n", sinal, numEncontrados - falhas, falhas);
+        } else if (sinal != 0){
+            printf("> Sinal invalido!\n");
+        }
+    }
+    for (size_t i = 0; i < numEncontrados; i++){
+        if (encontrados[i].pidfd >= 0){
+            close(encontrados[i].pidfd);
+        }
+    }
+    free(encontrados);
+    free(contexto.pares);
+    return 0;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes auxiliares dos snapshots do sistema
+//
+// Formato do arquivo (inteiros na ordem de bytes da maquina):
+//   CabecalhoSnapshot
+//   uint32_t deslocamentos[numTextos]   -> inicio de cada texto na tabela
+//   char     textos[tamanhoTextos]      -> textos unicos, ordenados e terminados em '\0',
+//                                          completados com zeros ate o alinhamento dos registros
+//   RegistroSnapshotDisco registros[numRegistros], ordenados por secao/chave/valor
+//
+// Como a tabela de textos e ordenada, comparar indices equivale a comparar textos
+// dentro de um mesmo arquivo, e a comparacao entre dois snapshots vira uma
+// intercalacao linear dos registros.
+enum { SECAO_PROCESSOS, SECAO_DRIVERS, SECAO_SOCKETS, SECAO_MONTAGENS, SECAO_ENDERECOS, NUM_SECOES };
+
+static const char *nomesSecoes[NUM_SECOES] = {"processo", "driver", "socket", "montagem", "endereco"};
+
+typedef struct {
+    char magico[8];
+    uint32_t versao;
+    uint32_t numTextos;
+    uint32_t tamanhoTextos;
+    uint32_t numRegistros;
+    int64_t criadoEm;
+} CabecalhoSnapshot;
+
+typedef struct {
+    uint32_t secao;
+    uint32_t chave;
+    uint32_t valor;
+} RegistroSnapshotDisco;
+
+typedef struct {
+    uint32_t secao;
+    char *chave;
+    char *valor;
+} RegistroSnapshot;
+
+typedef struct {
+    RegistroSnapshot *registros;
+    size_t numRegistros;
+    size_t capacidade;
+} ColetaSnapshot;
+
+typedef struct {
+    CabecalhoSnapshot cabecalho;
+    char *dados;
+    const uint32_t *deslocamentos;
+    const char *textos;
+    const RegistroSnapshotDisco *registros;
+} Snapshot;
+
+#ifdef __linux__
+/*---------------------------------------------------------*/
+// Adiciona um registro (secao, chave, valor) a coleta em memoria
+static int adicionaRegistroSnapshot(ColetaSnapshot *coleta, uint32_t secao, const char *chave, const char *valor){
+    if (coleta->numRegistros == coleta->capacidade){
+        size_t novaCapacidade = coleta->capacidade ? coleta->capacidade * 2 : 256;
+        RegistroSnapshot *novos = realloc(coleta->registros, novaCapacidade * sizeof(RegistroSnapshot));
+        if (novos == NULL){
+            return -1;
+        }
+        coleta->registros = novos;
+        coleta->capacidade = novaCapacidade;
+    }
+
+    RegistroSnapshot *registro = &coleta->registros[coleta->numRegistros];
+    registro->secao = secao;
+    registro->chave = strdup(chave);
+    registro->valor = strdup(valor);
+    if (registro->chave == NULL || registro->valor == NULL){
+        free(registro->chave);
+        free(registro->valor);
+        return -1;
+    }
+    coleta->numRegistros++;
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Libera a memoria usada pela coleta
+static void liberaColetaSnapshot(ColetaSnapshot *coleta){
+    for (size_t i = 0; i < coleta->numRegistros; i++){
+        free(coleta->registros[i].chave);
+        free(coleta->registros[i].valor);
+    }
+    free(coleta->registros);
+    memset(coleta, 0, sizeof(*coleta));
+}
+/*---------------------------------------------------------*/
+// Coleta os processos em execucao a partir do /proc (dados do 'ps aux')
+static void coletaProcessos(ColetaSnapshot *coleta){
+    DIR *diretorio = opendir("/proc");
+    struct dirent *entrada;
+
+    if (diretorio == NULL){
+        return;
+    }
+
+    while ((entrada = readdir(diretorio)) != NULL){
+        char caminho[MAX_CAMINHO];
+        char linha[512];
+
+        if (entrada->d_name[0] < '0' || entrada->d_name[0] > '9'){
+            continue;
+        }
+
+        snprintf(caminho, sizeof(caminho), "/proc/%.32s/stat", entrada->d_name);
+        FILE *arquivo = fopen(caminho, "r");
+        if (arquivo == NULL){
+            continue;
+        }
+
+        if (fgets(linha, sizeof(linha), arquivo) != NULL){
+            char *inicio = strchr(linha, '(');
+            char *fim = strrchr(linha, ')');
+            if (inicio != NULL && fim != NULL && fim > inicio){
+                *fim = '\0';
+                adicionaRegistroSnapshot(coleta, SECAO_PROCESSOS, entrada->d_name, inicio + 1);
+            }
+        }
+        fclose(arquivo);
+    }
+    closedir(diretorio);
+}
+/*---------------------------------------------------------*/
+// Coleta os modulos do kernel carregados (dados do 'lsmod')
+static void coletaDrivers(ColetaSnapshot *coleta){
+    FILE *arquivo = fopen("/proc/modules", "r");
+    char nome[128];
+    char tamanho[32];
+    char linha[512];
+
+    if (arquivo == NULL){
+        return;
+    }
+
+    while (fgets(linha, sizeof(linha), arquivo) != NULL){
+        if (sscanf(linha, "%127s %31s", nome, tamanho) == 2){
+            adicionaRegistroSnapshot(coleta, SECAO_DRIVERS, nome, tamanho);
+        }
+    }
+    fclose(arquivo);
+}
+/*---------------------------------------------------------*/
+// Converte um endereco hexadecimal do /proc/net para texto
+static void formataEnderecoProcNet(const char *hexadecimal, int ipv6, char *saida, size_t tamanho){
+    if (ipv6){
+        struct in6_addr endereco;
+        char parte[9] = {0};
+        for (int i = 0; i < 4; i++){
+            memcpy(parte, hexadecimal + i * 8, 8);
+            uint32_t palavra = (uint32_t)strtoul(parte, NULL, 16);
+            memcpy(&endereco.s6_addr[i * 4], &palavra, 4);
+        }
+        inet_ntop(AF_INET6, &endereco, saida, tamanho);
+    } else {
+        struct in_addr endereco;
+        endereco.s_addr = (uint32_t)strtoul(hexadecimal, NULL, 16);
+        inet_ntop(AF_INET, &endereco, saida, tamanho);
+    }
+}
+/*---------------------------------------------------------*/
+// Coleta os sockets TCP em escuta e UDP abertos (dados do 'ss -tuln')
+static void coletaSockets(ColetaSnapshot *coleta){
+    const struct { const char *arquivo; const char *protocolo; int ipv6; const char *estado; } fontes[] = {
+        {"/proc/net/tcp",  "tcp",  0, "0A"},
+        {"/proc/net/tcp6", "tcp6", 1, "0A"},
+        {"/proc/net/udp",  "udp",  0, "07"},
+        {"/proc/net/udp6", "udp6", 1, "07"},
+    };
+
+    for (size_t f = 0; f < sizeof(fontes) / sizeof(fontes[0]); f++){
+        FILE *arquivo = fopen(fontes[f].arquivo, "r");
+        char linha[512];
+
+        if (arquivo == NULL){
+            continue;
+        }
+
+        // A primeira linha e o cabecalho das colunas
+        if (fgets(linha, sizeof(linha), arquivo) == NULL){
+            fclose(arquivo);
+            continue;
+        }
+
+        while (fgets(linha, sizeof(linha), arquivo) != NULL){
+            char local[64];
+            char remoto[64];
+            char estado[8];
+            char endereco[INET6_ADDRSTRLEN];
+            char chave[128];
+
+            if (sscanf(linha, "%*s %63s %63s %7s", local, remoto, estado) != 3 || strcmp(estado, fontes[f].estado) != 0){
+                continue;
+            }
+
+            char *porta = strchr(local, ':');
+            if (porta == NULL){
+                continue;
+            }
+            *porta++ = '\0';
+
+            formataEnderecoProcNet(local, fontes[f].ipv6, endereco, sizeof(endereco));
+            snprintf(chave, sizeof(chave), "%s %s:%lu", fontes[f].protocolo, endereco, strtoul(porta, NULL, 16));
+            adicionaRegistroSnapshot(coleta, SECAO_SOCKETS, chave, "");
+        }
+        fclose(arquivo);
+    }
+}
+/*---------------------------------------------------------*/
+// Coleta os pontos de montagem (dados do 'df -h')
+static void coletaMontagens(ColetaSnapshot *coleta){
+    FILE *arquivo = fopen("/proc/self/mounts", "r");
+    char dispositivo[256];
+    char ponto[256];
+    char tipo[64];
+    char opcoes[512];
+    char valor[1024];
+    char linha[1200];
+
+    if (arquivo == NULL){
+        return;
+    }
+
+    while (fgets(linha, sizeof(linha), arquivo) != NULL){
+        if (sscanf(linha, "%255s %255s %63s %511s", dispositivo, ponto, tipo, opcoes) == 4){
+            snprintf(valor, sizeof(valor), "%s %s %s", dispositivo, tipo, opcoes);
+            adicionaRegistroSnapshot(coleta, SECAO_MONTAGENS, ponto, valor);
+        }
+    }
+    fclose(arquivo);
+}
+/*---------------------------------------------------------*/
+// Coleta os enderecos das interfaces de rede (dados do 'ip addr')
+static void coletaEnderecos(ColetaSnapshot *coleta){
+    struct ifaddrs *interfaces;
+
+    if (getifaddrs(&interfaces) != 0){
+        return;
+    }
+
+    for (struct ifaddrs *atual = interfaces; atual != NULL; atual = atual->ifa_next){
+        char endereco[INET6_ADDRSTRLEN];
+        char chave[128];
+        char valor[64];
+        int prefixo = 0;
+
+        if (atual->ifa_addr == NULL){
+            continue;
+        }
+
+        if (atual->ifa_addr->sa_family == AF_INET){
+            inet_ntop(AF_INET, &((struct sockaddr_in *)atual->ifa_addr)->sin_addr, endereco, sizeof(endereco));
+            if (atual->ifa_netmask != NULL){
+                prefixo = __builtin_popcount(((struct sockaddr_in *)atual->ifa_netmask)->sin_addr.s_addr);
+            }
+        } else if (atual->ifa_addr->sa_family == AF_INET6){
+            inet_ntop(AF_INET6, &((struct sockaddr_in6 *)atual->ifa_addr)->sin6_addr, endereco, sizeof(endereco));
+            if (atual->ifa_netmask != NULL){
+                const unsigned char *mascara = ((struct sockaddr_in6 *)atual->ifa_netmask)->sin6_addr.s6_addr;
+                for (int i = 0; i < 16; i++){
+                    prefixo += __builtin_popcount(mascara[i]);
+                }
+            }
+        } else {
+            continue;
+        }
+
+        snprintf(chave, sizeof(chave), "%s %s/%d", atual->ifa_name, endereco, prefixo);
+        snprintf(valor, sizeof(valor), "%s", (atual->ifa_flags & IFF_UP) ? "UP" : "DOWN");
+        adicionaRegistroSnapshot(coleta, SECAO_ENDERECOS, chave, valor);
+    }
+    freeifaddrs(interfaces);
+}
+#endif
+/*---------------------------------------------------------*/
+// Compara dois textos para ordenacao da tabela de textos
+static int comparaTextos(const void *a, const void *b){
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+/*---------------------------------------------------------*/
+// Compara dois registros ja convertidos em indices da tabela de textos
+static int comparaRegistrosDisco(const void *a, const void *b){
+    const RegistroSnapshotDisco *x = a;
+    const RegistroSnapshotDisco *y = b;
+
+    if (x->secao != y->secao){
+        return x->secao < y->secao ? -1 : 1;
+    }
+    if (x->chave != y->chave){
+        return x->chave < y->chave ? -1 : 1;
+    }
+    if (x->valor != y->valor){
+        return x->valor < y->valor ? -1 : 1;
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Grava a coleta em disco com a tabela de textos internada e os registros ordenados
+static int gravaSnapshot(const ColetaSnapshot *coleta, const char *caminho){
+    size_t numTextos = 0;
+    size_t tamanhoTextos = 0;
+    int resultado = -1;
+    char **textos = malloc((coleta->numRegistros * 2 + 1) * sizeof(char *));
+    uint32_t *deslocamentos = NULL;
+    RegistroSnapshotDisco *registros = NULL;
+    FILE *arquivo = NULL;
+    char temporario[MAX_CAMINHO + 16];
+
+    if (textos == NULL){
+        return -1;
+    }
+
+    for (size_t i = 0; i < coleta->numRegistros; i++){
+        textos[numTextos++] = coleta->registros[i].chave;
+        textos[numTextos++] = coleta->registros[i].valor;
+    }
+    qsort(textos, numTextos, sizeof(char *), comparaTextos);
+
+    // Remove os textos repetidos, mantendo apenas uma copia de cada
+    size_t unicos = 0;
+    for (size_t i = 0; i < numTextos; i++){
+        if (unicos == 0 || strcmp(textos[unicos - 1], textos[i]) != 0){
+            textos[unicos++] = textos[i];
+        }
+    }
+    numTextos = unicos;
+
+    deslocamentos = malloc((numTextos + 1) * sizeof(uint32_t));
+    registros = malloc((coleta->numRegistros + 1) * sizeof(RegistroSnapshotDisco));
+    if (deslocamentos == NULL || registros == NULL){
+        goto fim;
+    }
+
+    for (size_t i = 0; i < numTextos; i++){
+        deslocamentos[i] = (uint32_t)tamanhoTextos;
+        tamanhoTextos += strlen(textos[i]) + 1;
+    }
+
+    for (size_t i = 0; i < coleta->numRegistros; i++){
+        char **chave = bsearch(&coleta->registros[i].chave, textos, numTextos, sizeof(char *), comparaTextos);
+        char **valor = bsearch(&coleta->registros[i].valor, textos, numTextos, sizeof(char *), comparaTextos);
+        registros[i].secao = coleta->registros[i].secao;
+        registros[i].chave = (uint32_t)(chave - textos);
+        registros[i].valor = (uint32_t)(valor - textos);
+    }
+    qsort(registros, coleta->numRegistros, sizeof(RegistroSnapshotDisco), comparaRegistrosDisco);
+
+    // Remove registros identicos (ex.: o mesmo socket aberto duas vezes)
+    size_t numRegistros = 0;
+    for (size_t i = 0; i < coleta->numRegistros; i++){
+        if (numRegistros == 0 || comparaRegistrosDisco(&registros[numRegistros - 1], &registros[i]) != 0){
+            registros[numRegistros++] = registros[i];
+        }
+    }
+
+    CabecalhoSnapshot cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magico, SNAPSHOT_MAGICO, sizeof(SNAPSHOT_MAGICO));
+    cabecalho.versao = SNAPSHOT_VERSAO;
+    cabecalho.numTextos = (uint32_t)numTextos;
+    // A tabela de textos e completada com zeros para que os registros fiquem alinhados no arquivo
+    size_t alinhamento = _Alignof(RegistroSnapshotDisco);
+    size_t tamanhoTextosAlinhado = (tamanhoTextos + alinhamento - 1) / alinhamento * alinhamento;
+    cabecalho.tamanhoTextos = (uint32_t)tamanhoTextosAlinhado;
+    cabecalho.numRegistros = (uint32_t)numRegistros;
+    cabecalho.criadoEm = (int64_t)time(NULL);
+
+    // O snapshot e gravado em um arquivo temporario e renomeado, para que uma falha nao estrague o anterior
+    snprintf(temporario, sizeof(temporario), "%s.%d", caminho, (int)getpid());
+    arquivo = fopen(temporario, "wb");
+    if (arquivo == NULL){
+        goto fim;
+    }
+
+    if (fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 ||
+        fwrite(deslocamentos, sizeof(uint32_t), numTextos, arquivo) != numTextos){
+        goto fim;
+    }
+    for (size_t i = 0; i < numTextos; i++){
+        if (fwrite(textos[i], 1, strlen(textos[i]) + 1, arquivo) != strlen(textos[i]) + 1){
+            goto fim;
+        }
+    }
+    if (fwrite("\0\0\0\0\0\0\0", 1, tamanhoTextosAlinhado - tamanhoTextos, arquivo) != tamanhoTextosAlinhado - tamanhoTextos){
+        goto fim;
+    }
+    if (fwrite(registros, sizeof(RegistroSnapshotDisco), numRegistros, arquivo) != numRegistros){
+        goto fim;
+    }
+    resultado = 0;
+
+fim:
+    if (arquivo != NULL){
+        if (fclose(arquivo) != 0 || (resultado == 0 && rename(temporario, caminho) != 0)){
+            resultado = -1;
+        }
+        if (resultado != 0){
+            remove(temporario);
+        }
+    }
+    free(textos);
+    free(deslocamentos);
+    free(registros);
+    return resultado;
+}
+/*---------------------------------------------------------*/
+// Carrega um snapshot do disco validando o cabecalho e os limites das tabelas
+static int carregaSnapshot(const char *caminho, Snapshot *snapshot){
+    FILE *arquivo = fopen(caminho, "rb");
+    long tamanho;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    if (arquivo == NULL){
+        return -1;
+    }
+
+    if (fseek(arquivo, 0, SEEK_END) != 0 || (tamanho = ftell(arquivo)) < (long)sizeof(CabecalhoSnapshot) ||
+        fseek(arquivo, 0, SEEK_SET) != 0){
+        fclose(arquivo);
+        return -1;
+    }
+
+    snapshot->dados = malloc((size_t)tamanho);
+    if (snapshot->dados == NULL || fread(snapshot->dados, 1, (size_t)tamanho, arquivo) != (size_t)tamanho){
+        fclose(arquivo);
+        free(snapshot->dados);
+        snapshot->dados = NULL;
+        return -1;
+    }
+    fclose(arquivo);
+
+    CabecalhoSnapshot *cabecalho = &snapshot->cabecalho;
+    memcpy(cabecalho, snapshot->dados, sizeof(CabecalhoSnapshot));
+
+    uint64_t esperado = sizeof(CabecalhoSnapshot) + (uint64_t)cabecalho->numTextos * sizeof(uint32_t) +
+                        cabecalho->tamanhoTextos + (uint64_t)cabecalho->numRegistros * sizeof(RegistroSnapshotDisco);
+
+    if (memcmp(cabecalho->magico, SNAPSHOT_MAGICO, sizeof(SNAPSHOT_MAGICO)) != 0 ||
+        cabecalho->versao != SNAPSHOT_VERSAO || esperado != (uint64_t)tamanho ||
+        cabecalho->tamanhoTextos % _Alignof(RegistroSnapshotDisco) != 0){
+        free(snapshot->dados);
+        snapshot->dados = NULL;
+        return -1;
+    }
+
+    snapshot->deslocamentos = (const uint32_t *)(snapshot->dados + sizeof(CabecalhoSnapshot));
+    snapshot->textos = (const char *)(snapshot->deslocamentos + cabecalho->numTextos);
+    snapshot->registros = (const RegistroSnapshotDisco *)(snapshot->textos + cabecalho->tamanhoTextos);
+
+    // Garante que nenhum indice aponte para fora das tabelas
+    if (cabecalho->tamanhoTextos > 0 && snapshot->textos[cabecalho->tamanhoTextos - 1] != '\0'){
+        free(snapshot->dados);
+        snapshot->dados = NULL;
+        return -1;
+    }
+    for (uint32_t i = 0; i < cabecalho->numTextos; i++){
+        if (snapshot->deslocamentos[i] >= cabecalho->tamanhoTextos){
+            free(snapshot->dados);
+            snapshot->dados = NULL;
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < cabecalho->numRegistros; i++){
+        const RegistroSnapshotDisco *registro = &snapshot->registros[i];
+        if (registro->secao >= NUM_SECOES || registro->chave >= cabecalho->numTextos || registro->valor >= cabecalho->numTextos){
+            free(snapshot->dados);
+            snapshot->dados = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Retorna o texto de indice informado da tabela de textos do snapshot
+static const char *textoSnapshot(const Snapshot *snapshot, uint32_t indice){
+    return snapshot->textos + snapshot->deslocamentos[indice];
+}
+/*---------------------------------------------------------*/
+// Captura processos, drivers, sockets, montagens e enderecos em um arquivo binario
+int capturarSnapshot(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    char caminho[MAX_CAMINHO];
+    ColetaSnapshot coleta = {0};
+
+    if (obtemTexto(argc, argv, 0, "Digite o arquivo onde o snapshot sera salvo:", caminho, sizeof(caminho)) != 0){
+        printf("> Caminho invalido!\n");
+        return -1;
+    }
+
+    coletaProcessos(&coleta);
+    coletaDrivers(&coleta);
+    coletaSockets(&coleta);
+    coletaMontagens(&coleta);
+    coletaEnderecos(&coleta);
+
+    int resultado = gravaSnapshot(&coleta, caminho);
+    if (resultado != 0){
+        printf("> Nao foi possivel gravar o snapshot em '%s'!\n", caminho);
+    } else {
+        printf("> Snapshot com %zu registros salvo em '%s'!\n", coleta.numRegistros, caminho);
+    }
+    liberaColetaSnapshot(&coleta);
+    return resultado;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Compara dois snapshots exibindo apenas o que foi adicionado, removido ou alterado
+int compararSnapshots(int argc, char *argv[]){
+    printaDivisao();
+    char caminhoAntigo[MAX_CAMINHO];
+    char caminhoNovo[MAX_CAMINHO];
+    Snapshot antigo;
+    Snapshot novo;
+
+    if (obtemTexto(argc, argv, 0, "Digite o arquivo do snapshot antigo:", caminhoAntigo, sizeof(caminhoAntigo)) != 0 ||
+        obtemTexto(argc, argv, 1, "Digite o arquivo do snapshot novo:", caminhoNovo, sizeof(caminhoNovo)) != 0){
+        printf("> Caminho invalido!\n");
+        return -1;
+    }
+
+    if (carregaSnapshot(caminhoAntigo, &antigo) != 0){
+        printf("> O arquivo '%s' nao e um snapshot valido!\n", caminhoAntigo);
+        return -1;
+    }
+    if (carregaSnapshot(caminhoNovo, &novo) != 0){
+        printf("> O arquivo '%s' nao e um snapshot valido!\n", caminhoNovo);
+        free(antigo.dados);
+        return -1;
+    }
+
+    // Intercala os registros ordenados dos dois arquivos em uma unica passada
+    uint32_t i = 0;
+    uint32_t j = 0;
+    size_t adicionados = 0;
+    size_t removidos = 0;
+    size_t alterados = 0;
+
+    while (i < antigo.cabecalho.numRegistros || j < novo.cabecalho.numRegistros){
+        const RegistroSnapshotDisco *a = i < antigo.cabecalho.numRegistros ? &antigo.registros[i] : NULL;
+        const RegistroSnapshotDisco *b = j < novo.cabecalho.numRegistros ? &novo.registros[j] : NULL;
+        int ordem;
+
+        if (a == NULL){
+            ordem = 1;
+        } else if (b == NULL){
+            ordem = -1;
+        } else if (a->secao != b->secao){
+            ordem = a->secao < b->secao ? -1 : 1;
+        } else {
+            ordem = strcmp(textoSnapshot(&antigo, a->chave), textoSnapshot(&novo, b->chave));
+        }
+
+        if (ordem < 0){
+            printf("- %-9s %s %s\n", nomesSecoes[a->secao], textoSnapshot(&antigo, a->chave), textoSnapshot(&antigo, a->valor));
+            removidos++;
+            i++;
+        } else if (ordem > 0){
+            printf("+ %-9s %s %s\n", nomesSecoes[b->secao], textoSnapshot(&novo, b->chave), textoSnapshot(&novo, b->valor));
+            adicionados++;
+            j++;
+        } else {
+            const char *valorAntigo = textoSnapshot(&antigo, a->valor);
+            const char *valorNovo = textoSnapshot(&novo, b->valor);
+            if (strcmp(valorAntigo, valorNovo) != 0){
+                printf("~ %-9s %s: %s -> %s\n", nomesSecoes[a->secao], textoSnapshot(&antigo, a->chave), valorAntigo, valorNovo);
+                alterados++;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    printf("\n> %zu adicionados, %zu removidos, %zu alterados.\n", adicionados, removidos, alterados);
+
+    free(antigo.dados);
+    free(novo.dados);
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes auxiliares do relatorio de diagnostico
+//
+// Cada secao roda em um processo filho proprio com a saida ligada a um pipe.
+// Um unico laco com poll() le todos os pipes ao mesmo tempo, guardando a saida
+// de cada secao no seu proprio buffer, e encerra as secoes que passam do prazo.
+// Assim o tempo total fica limitado pela secao mais lenta, nao pela soma delas.
+typedef struct {
+    const char *titulo;
+    const char *comando;
+    int prazoSegundos;
+} SecaoRelatorio;
+
+typedef struct {
+    char *dados;
+    size_t tamanho;
+    size_t capacidade;
+} BufferSaida;
+
+#ifdef __linux__
+/*---------------------------------------------------------*/
+// Retorna o tempo monotonic atual em segundos
+static double tempoAtual(){
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+/*---------------------------------------------------------*/
+// Acrescenta dados ao buffer, descartando o que passar do limite informado
+static void acrescentaBuffer(BufferSaida *buffer, const char *dados, size_t tamanho, size_t limite){
+    if (buffer->tamanho + tamanho > limite){
+        tamanho = buffer->tamanho < limite ? limite - buffer->tamanho : 0;
+    }
+    if (tamanho == 0){
+        return;
+    }
+
+    if (buffer->tamanho + tamanho > buffer->capacidade){
+        size_t novaCapacidade = buffer->capacidade ? buffer->capacidade : 4096;
+        while (novaCapacidade < buffer->tamanho + tamanho){
+            novaCapacidade *= 2;
+        }
+        char *novos = realloc(buffer->dados, novaCapacidade);
+        if (novos == NULL){
+            return;
+        }
+        buffer->dados = novos;
+        buffer->capacidade = novaCapacidade;
+    }
+
+    memcpy(buffer->dados + buffer->tamanho, dados, tamanho);
+    buffer->tamanho += tamanho;
+}
+/*---------------------------------------------------------*/
+// Executa um comando do shell em um processo filho com a saida ligada a um pipe
+//
+// O filho recebe o /dev/null como entrada e vira lider do proprio grupo de
+// processos, para que o grupo inteiro possa ser encerrado com kill(-pid).
+#define PRAZO_ENCERRAMENTO_FILHO 2
+
+static pid_t iniciaProcessoFilho(const char *comando, int *descritor){
+    int canal[2];
+
+    if (pipe2(canal, O_CLOEXEC) != 0){
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0){
+        close(canal[0]);
+        close(canal[1]);
+        return -1;
+    }
+
+    if (pid == 0){
+        int nulo = open("/dev/null", O_RDONLY);
+        if (nulo >= 0){
+            dup2(nulo, STDIN_FILENO);
+            close(nulo);
+        }
+        dup2(canal[1], STDOUT_FILENO);
+        dup2(canal[1], STDERR_FILENO);
+        close(canal[0]);
+        close(canal[1]);
+        setpgid(0, 0);
+        execl("/bin/sh", "sh", "-c", comando, (char *)NULL);
+        _exit(127);
+    }
+
+    setpgid(pid, pid);
+    close(canal[1]);
+    *descritor = canal[0];
+    return pid;
+}
+/*---------------------------------------------------------*/
+// Pede ao grupo do filho para terminar e espera um pouco; quem nao sair a tempo recebe SIGKILL
+static void encerraProcessoFilho(pid_t pid, int *status){
+    double limite = tempoAtual() + PRAZO_ENCERRAMENTO_FILHO;
+
+    kill(-pid, SIGTERM);
+    while (waitpid(pid, status, WNOHANG) == 0){
+        if (tempoAtual() >= limite){
+            kill(-pid, SIGKILL);
+            waitpid(pid, status, 0);
+            return;
+        }
+        usleep(20000);
+    }
+
+    // O lider saiu, mas algum processo do grupo pode ter ignorado o SIGTERM
+    kill(-pid, SIGKILL);
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes da saida de comandos longos
+//
+// A saida do filho chega por um pipe e e lida em blocos grandes para um buffer
+// de tamanho fixo. Cada bloco so e consumido ate a ultima quebra de linha
+// completa; o resto espera o proximo bloco. O filtro procura o texto com memmem()
+// sobre o bloco inteiro, e nao linha a linha, entao trechos sem nenhuma ocorrencia
+// sao descartados de uma vez. Os limites de primeiras linhas encerram o filho
+// assim que sao atingidos, e o paginador so le o que precisa para a tela atual.
+// A memoria usada tem teto fixo, qualquer que seja o tamanho da saida.
+#define TAMANHO_BLOCO_SAIDA (256 * 1024)
+#define TAMANHO_PIPE_SAIDA (1024 * 1024)
+#define LIMITE_TEXTO_PAGINADOR (8 * 1024 * 1024)
+#define LIMITE_LINHAS_PAGINADOR 200000
+#define LIMITE_CAUDA_SAIDA 100000
+#define LIMITE_TEXTO_CAUDA (8 * 1024 * 1024)
+
+typedef struct {
+    int descritor;
+    pid_t pid;
+    char *dados;
+    size_t inicio;
+    size_t completos;
+    size_t fim;
+    int terminou;
+    const char *filtro;
+    size_t tamanhoFiltro;
+    long linhasLidas;
+} FluxoDeSaida;
+
+typedef struct {
+    char *texto;
+    size_t tamanhoTexto;
+    size_t *inicios;
+    long numLinhas;
+    long descartadas;
+} LinhasDoPaginador;
+/*---------------------------------------------------------*/
+// Conta as quebras de linha de um trecho
+static long contaLinhas(const char *dados, size_t tamanho){
+    long linhas = 0;
+    const char *fim = dados + tamanho;
+
+    while ((dados = memchr(dados, '\n', (size_t)(fim - dados))) != NULL){
+        linhas++;
+        dados++;
+    }
+    return linhas;
+}
+/*---------------------------------------------------------*/
+// Le mais um bloco do filho e atualiza o fim das linhas completas; retorna 0 no fim da saida
+static int leMaisSaida(FluxoDeSaida *fluxo){
+    if (fluxo->inicio > 0){
+        memmove(fluxo->dados, fluxo->dados + fluxo->inicio, fluxo->fim - fluxo->inicio);
+        fluxo->fim -= fluxo->inicio;
+        fluxo->completos -= fluxo->inicio;
+        fluxo->inicio = 0;
+    }
+
+    ssize_t lidos;
+    do {
+        lidos = read(fluxo->descritor, fluxo->dados + fluxo->fim, TAMANHO_BLOCO_SAIDA - fluxo->fim);
+    } while (lidos < 0 && errno == EINTR);
+
+    if (lidos <= 0){
+        fluxo->terminou = 1;
+        fluxo->completos = fluxo->fim;
+        return 0;
+    }
+
+    // So o trecho novo precisa ser examinado para achar a ultima quebra de linha
+    char *ultima = memrchr(fluxo->dados + fluxo->fim, '\n', (size_t)lidos);
+    fluxo->fim += (size_t)lidos;
+    if (ultima != NULL){
+        fluxo->completos = (size_t)(ultima - fluxo->dados) + 1;
+    } else if (fluxo->inicio == 0 && fluxo->fim == TAMANHO_BLOCO_SAIDA){
+        // Uma linha maior que o buffer inteiro e entregue em pedacos
+        fluxo->completos = fluxo->fim;
+    }
+    return 1;
+}
+/*---------------------------------------------------------*/
+// Entrega a proxima linha que passa pelo filtro; o ponteiro vale ate a proxima chamada
+static int proximaLinhaDeSaida(FluxoDeSaida *fluxo, const char **linha, size_t *tamanho){
+    for (;;){
+        char *base = fluxo->dados + fluxo->inicio;
+        size_t disponivel = fluxo->completos - fluxo->inicio;
+
+        if (disponivel > 0){
+            char *comeco = base;
+
+            if (fluxo->tamanhoFiltro > 0){
+                char *achado = memmem(base, disponivel, fluxo->filtro, fluxo->tamanhoFiltro);
+                if (achado == NULL){
+                    fluxo->linhasLidas += contaLinhas(base, disponivel);
+                    fluxo->inicio = fluxo->completos;
+                    continue;
+                }
+                comeco = memrchr(base, '\n', (size_t)(achado - base));
+                comeco = comeco != NULL ? comeco + 1 : base;
+                fluxo->linhasLidas += contaLinhas(base, (size_t)(comeco - base));
+            }
+
+            char *quebra = memchr(comeco, '\n', (size_t)(base + disponivel - comeco));
+            *linha = comeco;
+            *tamanho = quebra != NULL ? (size_t)(quebra - comeco) : (size_t)(base + disponivel - comeco);
+            fluxo->inicio = (size_t)(comeco - fluxo->dados) + *tamanho + (quebra != NULL ? 1 : 0);
+            fluxo->linhasLidas++;
+            return 1;
+        }
+
+        if (fluxo->terminou || !leMaisSaida(fluxo)){
+            if (fluxo->completos > fluxo->inicio){
+                continue;
+            }
+            return 0;
+        }
+    }
+}
+/*---------------------------------------------------------*/
+// Grava um trecho inteiro na saida padrao
+static int escreveSaidaPadrao(const char *dados, size_t tamanho){
+    while (tamanho > 0){
+        ssize_t escritos = write(STDOUT_FILENO, dados, tamanho);
+        if (escritos < 0 && errno == EINTR){
+            continue;
+        }
+        if (escritos <= 0){
+            return -1;
+        }
+        dados += escritos;
+        tamanho -= (size_t)escritos;
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Repassa a saida do filho sem filtro nem limite; com splice() os dados nao passam pelo programa
+static void repassaSaida(FluxoDeSaida *fluxo){
+    ssize_t movidos;
+
+    while ((movidos = splice(fluxo->descritor, NULL, STDOUT_FILENO, NULL, TAMANHO_PIPE_SAIDA, SPLICE_F_MOVE | SPLICE_F_MORE)) > 0){
+    }
+
+    // Terminais e alguns arquivos nao aceitam splice(); nesse caso os blocos sao copiados
+    if (movidos < 0){
+        while (leMaisSaida(fluxo)){
+            if (escreveSaidaPadrao(fluxo->dados, fluxo->fim) != 0){
+                break;
+            }
+            fluxo->inicio = fluxo->completos = fluxo->fim = 0;
+        }
+    }
+    fluxo->terminou = 1;
+}
+/*---------------------------------------------------------*/
+// Escreve as linhas filtradas, parando o filho ao atingir o limite de primeiras linhas
+static void escreveLinhasDeSaida(FluxoDeSaida *fluxo, long limite){
+    char *saida = malloc(TAMANHO_BLOCO_SAIDA);
+    size_t usados = 0;
+    long escritas = 0;
+    const char *linha;
+    size_t tamanho;
+
+    if (saida == NULL){
+        return;
+    }
+
+    while ((limite <= 0 || escritas < limite) && proximaLinhaDeSaida(fluxo, &linha, &tamanho)){
+        if (usados + tamanho + 1 > TAMANHO_BLOCO_SAIDA){
+            escreveSaidaPadrao(saida, usados);
+            usados = 0;
+        }
+        if (tamanho + 1 > TAMANHO_BLOCO_SAIDA){
+            escreveSaidaPadrao(linha, tamanho);
+            escreveSaidaPadrao("\n", 1);
+        } else {
+            memcpy(saida + usados, linha, tamanho);
+            saida[usados + tamanho] = '\n';
+            usados += tamanho + 1;
+        }
+        escritas++;
+    }
+    escreveSaidaPadrao(saida, usados);
+    free(saida);
+}
+/*---------------------------------------------------------*/
+// Guarda somente as ultimas linhas e as escreve no fim da saida
+//
+// O texto vai para um anel de bytes com teto fixo, e cada linha guarda so a sua
+// posicao e o seu tamanho nele. Linhas curtas ocupam so o que tem, e quando as
+// ultimas N linhas nao cabem no teto as mais antigas sao omitidas.
+static void escreveCaudaDeSaida(FluxoDeSaida *fluxo, long quantidade){
+    char *anel = malloc(LIMITE_TEXTO_CAUDA);
+    unsigned long long *inicios = malloc((size_t)quantidade * sizeof(*inicios));
+    size_t *tamanhos = malloc((size_t)quantidade * sizeof(*tamanhos));
+    unsigned long long gravados = 0;
+    long total = 0;
+    const char *linha;
+    size_t tamanho;
+
+    if (anel == NULL || inicios == NULL || tamanhos == NULL){
+        free(anel);
+        free(inicios);
+        free(tamanhos);
+        return;
+    }
+
+    while (proximaLinhaDeSaida(fluxo, &linha, &tamanho)){
+        long posicao = total++ % quantidade;
+        size_t deslocamento = (size_t)(gravados % LIMITE_TEXTO_CAUDA);
+
+        // Uma linha maior que o anel inteiro fica so com o comeco
+        if (tamanho > LIMITE_TEXTO_CAUDA){
+            tamanho = LIMITE_TEXTO_CAUDA;
+        }
+        size_t primeiro = tamanho < LIMITE_TEXTO_CAUDA - deslocamento ? tamanho : LIMITE_TEXTO_CAUDA - deslocamento;
+        memcpy(anel + deslocamento, linha, primeiro);
+        memcpy(anel, linha + primeiro, tamanho - primeiro);
+        inicios[posicao] = gravados;
+        tamanhos[posicao] = tamanho;
+        gravados += tamanho;
+    }
+
+    // Linhas cujo texto ja foi sobrescrito por linhas mais novas nao podem ser escritas
+    long primeira = total > quantidade ? total - quantidade : 0;
+    long omitidas = 0;
+    while (primeira < total && gravados - inicios[primeira % quantidade] > LIMITE_TEXTO_CAUDA){
+        primeira++;
+        omitidas++;
+    }
+    if (omitidas > 0){
+        printf("> %ld linha(s) mais antiga(s) omitida(s): as ultimas linhas passam de %d MiB.\n",
+               omitidas, LIMITE_TEXTO_CAUDA / (1024 * 1024));
+        fflush(stdout);
+    }
+
+    for (long i = primeira; i < total; i++){
+        size_t deslocamento = (size_t)(inicios[i % quantidade] % LIMITE_TEXTO_CAUDA);
+        size_t primeiro = tamanhos[i % quantidade] < LIMITE_TEXTO_CAUDA - deslocamento ?
+                          tamanhos[i % quantidade] : LIMITE_TEXTO_CAUDA - deslocamento;
+        escreveSaidaPadrao(anel + deslocamento, primeiro);
+        escreveSaidaPadrao(anel, tamanhos[i % quantidade] - primeiro);
+        escreveSaidaPadrao("\n", 1);
+    }
+    free(anel);
+    free(inicios);
+    free(tamanhos);
+}
+/*---------------------------------------------------------*/
+// Guarda uma linha no paginador, descartando a metade mais antiga quando o limite e atingido
+static void acrescentaLinhaPaginador(LinhasDoPaginador *linhas, const char *linha, size_t tamanho){
+    if (tamanho > LIMITE_TEXTO_PAGINADOR / 4){
+        tamanho = LIMITE_TEXTO_PAGINADOR / 4;
+    }
+
+    if (linhas->numLinhas == LIMITE_LINHAS_PAGINADOR || linhas->tamanhoTexto + tamanho + 1 > LIMITE_TEXTO_PAGINADOR){
+        long metade = (linhas->numLinhas + 1) / 2;
+        size_t corte = metade < linhas->numLinhas ? linhas->inicios[metade] : linhas->tamanhoTexto;
+
+        memmove(linhas->texto, linhas->texto + corte, linhas->tamanhoTexto - corte);
+        linhas->tamanhoTexto -= corte;
+        for (long i = metade; i < linhas->numLinhas; i++){
+            linhas->inicios[i - metade] = linhas->inicios[i] - corte;
+        }
+        linhas->numLinhas -= metade;
+        linhas->descartadas += metade;
+    }
+
+    linhas->inicios[linhas->numLinhas++] = linhas->tamanhoTexto;
+    memcpy(linhas->texto + linhas->tamanhoTexto, linha, tamanho);
+    linhas->texto[linhas->tamanhoTexto + tamanho] = '\n';
+    linhas->tamanhoTexto += tamanho + 1;
+}
+/*---------------------------------------------------------*/
+// Le linhas do filho ate o paginador ter a linha pedida (numeracao absoluta); retorna 0 se a saida acabar antes
+static int carregaLinhaPaginador(FluxoDeSaida *fluxo, LinhasDoPaginador *linhas, long numero, long limite){
+    const char *linha;
+    size_t tamanho;
+
+    while (linhas->descartadas + linhas->numLinhas <= numero){
+        if ((limite > 0 && linhas->descartadas + linhas->numLinhas >= limite) || !proximaLinhaDeSaida(fluxo, &linha, &tamanho)){
+            return 0;
+        }
+        acrescentaLinhaPaginador(linhas, linha, tamanho);
+    }
+    return 1;
+}
+/*---------------------------------------------------------*/
+// Desenha uma pagina: as linhas a partir do topo e a linha de estado invertida
+static void desenhaPaginador(LinhasDoPaginador *linhas, long topo, int altura, const char *estado, const char *busca){
+    char texto[512];
+    int largura = tela.colunas < (int)sizeof(texto) ? tela.colunas : (int)sizeof(texto) - 1;
+
+    telaNovoQuadro();
+    for (int i = 0; i < altura && topo + i < linhas->descartadas + linhas->numLinhas; i++){
+        long indice = topo + i - linhas->descartadas;
+        const char *linha = linhas->texto + linhas->inicios[indice];
+        size_t tamanho = strcspn(linha, "\n");
+        int coluna = 0;
+
+        // Tabulacoes viram espacos; caracteres de controle e cada caractere UTF-8 inteiro viram um unico '?',
+        // pois uma celula da tela guarda um byte e meia sequencia quebraria o alinhamento das colunas
+        for (size_t k = 0; k < tamanho && coluna < largura; k++){
+            unsigned char byte = (unsigned char)linha[k];
+            if (byte == '\t'){
+                do {
+                    texto[coluna++] = ' ';
+                } while (coluna % 8 != 0 && coluna < largura);
+            } else if (byte >= 0x80){
+                while (k + 1 < tamanho && ((unsigned char)linha[k + 1] & 0xC0) == 0x80 && byte >= 0xC0){
+                    k++;
+                }
+                texto[coluna++] = '?';
+            } else {
+                texto[coluna++] = (byte < ' ' || byte == 127) ? '?' : (char)byte;
+            }
+        }
+        texto[coluna] = '\0';
+
+        // Linhas com o texto buscado aparecem em negrito
+        unsigned char atributo = (busca[0] != '\0' && memmem(linha, tamanho, busca, strlen(busca)) != NULL) ? ATRIBUTO_NEGRITO : 0;
+        telaEscreve(i, 0, texto, atributo);
+    }
+
+    snprintf(texto, sizeof(texto), "%-*.*s", largura, largura, estado);
+    telaEscreve(altura, 0, texto, ATRIBUTO_INVERTIDO);
+    telaApresenta();
+}
+/*---------------------------------------------------------*/
+// Mostra a saida tela a tela, lendo do filho somente o necessario para a pagina atual
+static void paginaSaida(FluxoDeSaida *fluxo, long limite){
+    LinhasDoPaginador linhas = {0};
+    struct termios original, bruto;
+    char estado[256];
+    char busca[128] = "";
+    char mensagem[96] = "";
+    long topo = 0;
+
+    linhas.texto = malloc(LIMITE_TEXTO_PAGINADOR);
+    linhas.inicios = malloc(LIMITE_LINHAS_PAGINADOR * sizeof(size_t));
+    if (linhas.texto == NULL || linhas.inicios == NULL || telaInicia() != 0 || tcgetattr(STDIN_FILENO, &original) != 0){
+        free(linhas.texto);
+        free(linhas.inicios);
+        escreveLinhasDeSaida(fluxo, limite);
+        return;
+    }
+
+    int altura;
+    bruto = original;
+    bruto.c_lflag &= ~(ICANON | ECHO);
+    bruto.c_cc[VMIN] = 1;
+    bruto.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &bruto);
+    telaAcrescenta("\x1b[?25l", 6);
+
+    for (;;){
+        // O tamanho e relido a cada pagina, acompanhando o redimensionamento do terminal
+        if (telaInicia() != 0){
+            break;
+        }
+        altura = tela.linhas - 1;
+        carregaLinhaPaginador(fluxo, &linhas, topo + altura - 1, limite);
+        long total = linhas.descartadas + linhas.numLinhas;
+        int completa = fluxo->terminou || (limite > 0 && total >= limite);
+
+        // As linhas descartadas pelo limite de memoria nao podem mais ser exibidas
+        if (topo < linhas.descartadas){
+            topo = linhas.descartadas;
+        }
+
+        snprintf(estado, sizeof(estado), " linhas %ld-%ld de %ld%s | Espaco/b pagina, Enter/k linha, g/G inicio/fim, / busca, n proxima, q sai %s",
+                 total > 0 ? topo + 1 : 0, topo + altura < total ? topo + altura : total, total, completa ? "" : "+", mensagem);
+        desenhaPaginador(&linhas, topo, altura, estado, busca);
+        mensagem[0] = '\0';
+
+        int tecla = getchar();
+        if (tecla == EOF || tecla == 'q' || tecla == 'Q'){
+            break;
+        }
+
+        switch (tecla){
+            case ' ': case 'f':
+                if (carregaLinhaPaginador(fluxo, &linhas, topo + altura, limite)){
+                    topo += altura;
+                }
+                break;
+            case '\n': case '\r': case 'j':
+                if (carregaLinhaPaginador(fluxo, &linhas, topo + altura, limite)){
+                    topo++;
+                }
+                break;
+            case 'b':
+                topo = topo > altura ? topo - altura : 0;
+                break;
+            case 'k':
+                topo = topo > 0 ? topo - 1 : 0;
+                break;
+            case 'g':
+                topo = 0;
+                break;
+            case 'G':
+                while (carregaLinhaPaginador(fluxo, &linhas, linhas.descartadas + linhas.numLinhas, limite)){
+                }
+                total = linhas.descartadas + linhas.numLinhas;
+                topo = total > altura ? total - altura : 0;
+                break;
+            case '/': {
+                // O texto buscado e digitado na propria linha de estado
+                size_t usados = 0;
+                busca[0] = '\0';
+                for (;;){
+                    snprintf(estado, sizeof(estado), "/%s", busca);
+                    desenhaPaginador(&linhas, topo, altura, estado, "");
+                    int caractere = getchar();
+                    if (caractere == '\n' || caractere == '\r' || caractere == EOF){
+                        break;
+                    }
+                    if ((caractere == 127 || caractere == '\b') && usados > 0){
+                        busca[--usados] = '\0';
+                    } else if (caractere == 27){
+                        usados = 0;
+                        busca[0] = '\0';
+                        break;
+                    } else if (caractere >= ' ' && caractere < 127 && usados + 1 < sizeof(busca)){
+                        busca[usados++] = (char)caractere;
+                        busca[usados] = '\0';
+                    }
+                }
+                if (busca[0] == '\0'){
+                    break;
+                }
+            }
+            /* fall through */
+            case 'n': {
+                if (busca[0] == '\0'){
+                    break;
+                }
+                size_t tamanhoBusca = strlen(busca);
+                long numero = topo + 1;
+                int achou = 0;
+
+                while (!achou && carregaLinhaPaginador(fluxo, &linhas, numero, limite)){
+                    if (numero < linhas.descartadas){
+                        numero = linhas.descartadas;
+                        continue;
+                    }
+                    const char *linha = linhas.texto + linhas.inicios[numero - linhas.descartadas];
+                    achou = memmem(linha, strcspn(linha, "\n"), busca, tamanhoBusca) != NULL;
+                    numero++;
+                }
+                if (achou){
+                    topo = numero - 1;
+                } else {
+                    snprintf(mensagem, sizeof(mensagem), "| '%s' nao encontrado", busca);
+                }
+                break;
+            }
+        }
+    }
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &original);
+    telaFinalizaQuadros(tela.linhas - 1);
+    free(linhas.texto);
+    free(linhas.inicios);
+}
+/*---------------------------------------------------------*/
+// Separa as opcoes "[texto] [+N|-N]": o texto filtra as linhas, +N mostra as primeiras N e -N as ultimas N
+static void separaOpcoesDeSaida(int argc, char *argv[], char *filtro, size_t tamanho, long *limite){
+    char opcoes[512] = "";
+
+    for (int i = 0; i < argc; i++){
+        snprintf(opcoes + strlen(opcoes), sizeof(opcoes) - strlen(opcoes), "%s%s", i > 0 ? " " : "", argv[i]);
+    }
+
+    *limite = 0;
+    char *ultima = strrchr(opcoes, ' ');
+    ultima = ultima != NULL ? ultima + 1 : opcoes;
+    if ((ultima[0] == '+' || ultima[0] == '-') && isdigit((unsigned char)ultima[1])){
+        char *fim;
+        long valor = strtol(ultima, &fim, 10);
+        if (*fim == '\0'){
+            *limite = valor;
+            *ultima = '\0';
+        }
+    }
+
+    size_t comprimento = strlen(opcoes);
+    while (comprimento > 0 && opcoes[comprimento - 1] == ' '){
+        opcoes[--comprimento] = '\0';
+    }
+    snprintf(filtro, tamanho, "%s", opcoes);
+}
+#endif
+/*---------------------------------------------------------*/
+// Executa um comando de saida longa passando-a pelo filtro, pelos limites e pelo paginador
+int exibeSaidaDeComando(const char *comando, int argc, char *argv[]){
+#ifdef __linux__
+    FluxoDeSaida fluxo = {0};
+    char filtro[256];
+    long limite;
+    int status = 0;
+
+    separaOpcoesDeSaida(argc, argv, filtro, sizeof(filtro), &limite);
+    if (limite < -LIMITE_CAUDA_SAIDA){
+        limite = -LIMITE_CAUDA_SAIDA;
+    }
+
+    // O buffer e alocado antes do fork, para que uma falha nao deixe um filho sem leitor
+    fluxo.dados = malloc(TAMANHO_BLOCO_SAIDA);
+    if (fluxo.dados == NULL){
+        return -1;
+    }
+    fflush(stdout);
+    fluxo.pid = iniciaProcessoFilho(comando, &fluxo.descritor);
+    if (fluxo.pid < 0){
+        free(fluxo.dados);
+        return -1;
+    }
+    fcntl(fluxo.descritor, F_SETPIPE_SZ, TAMANHO_PIPE_SAIDA);
+    fluxo.filtro = filtro;
+    fluxo.tamanhoFiltro = strlen(filtro);
+
+    if (limite < 0){
+        escreveCaudaDeSaida(&fluxo, -limite);
+    } else if (isatty(STDIN_FILENO) && isatty(STDOUT_FILENO)){
+        paginaSaida(&fluxo, limite);
+    } else if (fluxo.tamanhoFiltro == 0 && limite == 0){
+        repassaSaida(&fluxo);
+    } else {
+        escreveLinhasDeSaida(&fluxo, limite);
+    }
+
+    // Se a leitura parou antes do fim (limite atingido ou paginador fechado), o filho e encerrado
+    close(fluxo.descritor);
+    if (!fluxo.terminou){
+        encerraProcessoFilho(fluxo.pid, &status);
+    } else {
+        waitpid(fluxo.pid, &status, 0);
+    }
+    free(fluxo.dados);
+
+    if (limite < 0 || fluxo.tamanhoFiltro > 0){
+        printf("> %ld linha(s) lida(s) de '%s'.\n", fluxo.linhasLidas, comando);
+    }
+    printaMensagem(comando);
+    return fluxo.terminou && WIFEXITED(status) ? WEXITSTATUS(status) : 0;
+#else
+    return executarComando(comando);
+#endif
+}
+/*---------------------------------------------------------*/
+// Gera um relatorio com todas as informacoes do sistema e da rede executadas em paralelo
+int gerarRelatorio(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    char ip[MAX_ENDERECO];
+    char caminho[MAX_CAMINHO];
+    char comandoPing[MAX_ENDERECO + 32];
+    char comandoRota[MAX_ENDERECO + 32];
+
+    if (obtemTexto(argc, argv, 0, "Digite o endereco IP usado no ping e no rastreamento de rota:", ip, sizeof(ip)) != 0){
+        printf("> Endereco invalido!\n");
+        return -1;
+    }
+
+    if (obtemTexto(argc, argv, 1, "Digite o arquivo onde o relatorio sera salvo:", caminho, sizeof(caminho)) != 0){
+        printf("> Caminho invalido!\n");
+        return -1;
+    }
+
+    snprintf(comandoPing, sizeof(comandoPing), COMANDO_PING_LINUX, ip);
+    snprintf(comandoRota, sizeof(comandoRota), COMANDO_ROTA_LINUX, ip);
+
+    SecaoRelatorio secoes[] = {
+        {"Informacoes do Hardware",   COMANDO_HARDWARE_LINUX,     60},
+        {"Drivers Instalados",        COMANDO_DRIVERS_LINUX,      10},
+        {"Processos em Execucao",     COMANDO_PROCESSOS_LINUX,    10},
+        {"IP do Computador",          COMANDO_IP_LINUX,           10},
+        {"Ping",                      comandoPing,                10},
+        {"Rota do IP",                comandoRota,                60},
+        {"Mapeamentos de Rede",       COMANDO_MAPEAMENTOS_LINUX,  15},
+        {"Estatisticas de Rede",      COMANDO_ESTATISTICAS_LINUX, 10},
+    };
+    enum { NUM_SECOES_RELATORIO = sizeof(secoes) / sizeof(secoes[0]) };
+    const size_t limiteSecao = 8 * 1024 * 1024;
+
+    BufferSaida saidas[NUM_SECOES_RELATORIO];
+    pid_t pids[NUM_SECOES_RELATORIO];
+    int descritores[NUM_SECOES_RELATORIO];
+    int estados[NUM_SECOES_RELATORIO];
+    int esgotados[NUM_SECOES_RELATORIO];
+    double duracoes[NUM_SECOES_RELATORIO];
+    int abertos = 0;
+    double inicio = tempoAtual();
+
+    memset(saidas, 0, sizeof(saidas));
+    memset(esgotados, 0, sizeof(esgotados));
+
+    printf("> Executando %d secoes em paralelo...\n", NUM_SECOES_RELATORIO);
+    fflush(stdout);
+
+    for (int i = 0; i < NUM_SECOES_RELATORIO; i++){
+        estados[i] = -1;
+        duracoes[i] = 0;
+        pids[i] = iniciaProcessoFilho(secoes[i].comando, &descritores[i]);
+        if (pids[i] < 0){
+            descritores[i] = -1;
+        } else {
+            abertos++;
+        }
+    }
+
+    while (abertos > 0){
+        struct pollfd eventos[NUM_SECOES_RELATORIO];
+        int indices[NUM_SECOES_RELATORIO];
+        int numEventos = 0;
+        int aguardandoSaida = 0;
+        double agora = tempoAtual();
+        double proximoPrazo = -1;
+
+        for (int i = 0; i < NUM_SECOES_RELATORIO; i++){
+            if (pids[i] < 0 || estados[i] != -1 || esgotados[i]){
+                continue;
+            }
+            double prazo = inicio + secoes[i].prazoSegundos;
+            if (proximoPrazo < 0 || prazo < proximoPrazo){
+                proximoPrazo = prazo;
+            }
+            // Uma secao que ja fechou a saida so falta terminar; ela e conferida sem bloquear
+            if (descritores[i] < 0){
+                aguardandoSaida = 1;
+                continue;
+            }
+            eventos[numEventos].fd = descritores[i];
+            eventos[numEventos].events = POLLIN;
+            indices[numEventos++] = i;
+        }
+
+        int espera = proximoPrazo > agora ? (int)((proximoPrazo - agora) * 1000) + 1 : 0;
+        if (aguardandoSaida && espera > 20){
+            espera = 20;
+        }
+        if (poll(eventos, numEventos, espera) < 0 && errno != EINTR){
+            break;
+        }
+
+        agora = tempoAtual();
+        for (int k = 0; k < numEventos; k++){
+            int i = indices[k];
+
+            if (eventos[k].revents & (POLLIN | POLLHUP | POLLERR)){
+                char bloco[65536];
+                ssize_t lidos = read(descritores[i], bloco, sizeof(bloco));
+                if (lidos > 0){
+                    acrescentaBuffer(&saidas[i], bloco, (size_t)lidos, limiteSecao);
+                } else if (lidos == 0 || errno != EINTR){
+                    close(descritores[i]);
+                    descritores[i] = -1;
+                }
+            }
+        }
+
+        for (int i = 0; i < NUM_SECOES_RELATORIO; i++){
+            int status;
+            int terminou = 0;
+
+            if (pids[i] < 0 || estados[i] != -1 || esgotados[i]){
+                continue;
+            }
+
+            if (descritores[i] < 0 && waitpid(pids[i], &status, WNOHANG) == pids[i]){
+                estados[i] = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                terminou = 1;
+            } else if (agora >= inicio + secoes[i].prazoSegundos){
+                kill(-pids[i], SIGKILL);
+                waitpid(pids[i], &status, 0);
+                esgotados[i] = 1;
+                terminou = 1;
+            }
+
+            if (terminou){
+                if (descritores[i] >= 0){
+                    close(descritores[i]);
+                    descritores[i] = -1;
+                }
+                duracoes[i] = agora - inicio;
+                abertos--;
+                printf("  [%s] %s (%.1fs)\n", esgotados[i] ? "prazo" : estados[i] == 0 ? "ok" : "falha", secoes[i].titulo, duracoes[i]);
+                fflush(stdout);
+            }
+        }
+    }
+
+    // Monta o relatorio final na ordem fixa das secoes
+    FILE *arquivo = fopen(caminho, "w");
+    if (arquivo == NULL){
+        printf("> Nao foi possivel criar o arquivo '%s'!\n", caminho);
+    } else {
+        char dataHora[64];
+        time_t agora = time(NULL);
+        strftime(dataHora, sizeof(dataHora), "%d/%m/%Y %H:%M:%S", localtime(&agora));
+        fprintf(arquivo, "Relatorio de diagnostico - %s\n", dataHora);
+
+        for (int i = 0; i < NUM_SECOES_RELATORIO; i++){
+            fprintf(arquivo, "\n========== %s (%s) ==========\n", secoes[i].titulo, secoes[i].comando);
+            if (saidas[i].tamanho > 0){
+                fwrite(saidas[i].dados, 1, saidas[i].tamanho, arquivo);
+                if (saidas[i].dados[saidas[i].tamanho - 1] != '\n'){
+                    fputc('\n', arquivo);
+                }
+            }
+            if (pids[i] < 0){
+                fprintf(arquivo, "[nao foi possivel executar o comando]\n");
+            } else if (esgotados[i]){
+                fprintf(arquivo, "[prazo de %d segundos esgotado]\n", secoes[i].prazoSegundos);
+            } else {
+                fprintf(arquivo, "[%scodigo de saida %d em %.1f segundos]\n", estados[i] != 0 ? "falha: " : "", estados[i], duracoes[i]);
+            }
+        }
+        fclose(arquivo);
+        printf("> Relatorio salvo em '%s' (%.1f segundos)!\n", caminho, tempoAtual() - inicio);
+    }
+
+    for (int i = 0; i < NUM_SECOES_RELATORIO; i++){
+        free(saidas[i].dados);
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes auxiliares da execucao em varios alvos
+//
+// Um comando digitado (como "rede ip") e enviado a uma lista de alvos por um
+// transporte escolhido pelo formato do alvo: "local" executa o proprio programa,
+// "unix:/caminho" conversa com um agente ('--agente') por um socket Unix e
+// qualquer outro nome ("maquina", "usuario@maquina" ou "ssh:maquina") roda o
+// programa na maquina remota pelo ssh. No maximo MAX_ALVOS_PARALELOS alvos rodam
+// ao mesmo tempo, todos lidos por um unico laco com poll() como no relatorio,
+// cada um com o seu prazo. Cada linha da tabela sai assim que o alvo termina.
+#define MAX_ALVOS 256
+#define MAX_ALVOS_PARALELOS 8
+#define PRAZO_ALVO_SEGUNDOS 15
+#define LIMITE_SAIDA_ALVO (1024 * 1024)
+#define MARCA_FIM_AGENTE '\x1e'
+
+enum { ALVO_ESPERANDO, ALVO_RODANDO, ALVO_OK, ALVO_FALHOU, ALVO_PRAZO, ALVO_ERRO };
+
+typedef struct {
+    const char *prefixo;
+    const char *nome;
+    int (*inicia)(const char *alvo, int argc, char *argv[], pid_t *pid, int *descritor);
+} TransporteAlvo;
+
+typedef struct {
+    char nome[128];
+    const TransporteAlvo *transporte;
+    pid_t pid;
+    int descritor;
+    int situacao;
+    int estado;
+    double inicio;
+    double duracao;
+    BufferSaida saida;
+    size_t recebidos;
+    char ultimos[32];
+    size_t tamanhoUltimos;
+} ExecucaoAlvo;
+
+#ifdef __linux__
+static volatile sig_atomic_t agenteAtivo = 1;
+/*---------------------------------------------------------*/
+// Encerra o laco do agente ao receber SIGINT ou SIGTERM
+static void interrompeAgente(int sinal){
+    (void)sinal;
+    agenteAtivo = 0;
+}
+/*---------------------------------------------------------*/
+// Monta as palavras entre aspas simples, prontas para um 'sh -c'
+static int citaParaShell(int argc, char *argv[], char *destino, size_t tamanho){
+    size_t usados = 0;
+
+    destino[0] = '\0';
+    for (int i = 0; i < argc; i++){
+        if (usados + 3 >= tamanho){
+            return -1;
+        }
+        if (i > 0){
+            destino[usados++] = ' ';
+        }
+        destino[usados++] = '\'';
+        for (const char *c = argv[i]; *c != '\0'; c++){
+            // Uma aspa simples dentro da palavra vira '\''
+            if (*c == '\''){
+                if (usados + 5 >= tamanho){
+                    return -1;
+                }
+                memcpy(destino + usados, "'\\''", 4);
+                usados += 4;
+            } else if (usados + 2 < tamanho){
+                destino[usados++] = *c;
+            } else {
+                return -1;
+            }
+        }
+        destino[usados++] = '\'';
+        destino[usados] = '\0';
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Diz se a acao pode ser enviada a um alvo; as que abrem outra execucao remota ou um console nao podem
+static int acaoRemotaPermitida(const Acao *acao){
+    return acao != NULL && acao->executar != executarEmVarios && acao->executar != linhaDeComando;
+}
+/*---------------------------------------------------------*/
+// Descobre o caminho do proprio executavel
+static int caminhoDoExecutavel(char *caminho, size_t tamanho){
+    ssize_t lidos = readlink("/proc/self/exe", caminho, tamanho - 1);
+    if (lidos <= 0){
+        return -1;
+    }
+    caminho[lidos] = '\0';
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Transporte local: executa o proprio programa nesta maquina
+static int iniciaAlvoLocal(const char *alvo, int argc, char *argv[], pid_t *pid, int *descritor){
+    char caminho[MAX_CAMINHO];
+    char *palavras[1];
+    char executavel[MAX_CAMINHO + 16];
+    char argumentos[1024];
+    char comando[sizeof(executavel) + sizeof(argumentos) + 8];
+
+    if (caminhoDoExecutavel(caminho, sizeof(caminho)) != 0){
+        return -1;
+    }
+    palavras[0] = caminho;
+    if (citaParaShell(1, palavras, executavel, sizeof(executavel)) != 0 || citaParaShell(argc, argv, argumentos, sizeof(argumentos)) != 0){
+        return -1;
+    }
+
+    snprintf(comando, sizeof(comando), "exec %s %s", executavel, argumentos);
+    *pid = iniciaProcessoFilho(comando, descritor);
+    return *pid < 0 ? -1 : 0;
+}
+/*---------------------------------------------------------*/
+// Transporte ssh: executa o programa na maquina remota (COMANDOS_REMOTO define o nome dele la)
+static int iniciaAlvoSsh(const char *alvo, int argc, char *argv[], pid_t *pid, int *descritor){
+    const char *programa = getenv("COMANDOS_REMOTO");
+    char argumentos[1024];
+    char remoto[1100];
+    char palavrasSsh[2300];
+    char comando[2400];
+
+    if (strncmp(alvo, "ssh:", 4) == 0){
+        alvo += 4;
+    }
+    if (alvo[0] == '-' || citaParaShell(argc, argv, argumentos, sizeof(argumentos)) != 0){
+        return -1;
+    }
+
+    // O ssh junta os argumentos em uma linha para o shell remoto, entao o comando remoto e citado duas vezes
+    snprintf(remoto, sizeof(remoto), "%s %s", programa != NULL && programa[0] != '\0' ? programa : "comandos", argumentos);
+    char *palavras[2] = {(char *)alvo, remoto};
+    if (citaParaShell(2, palavras, palavrasSsh, sizeof(palavrasSsh)) != 0){
+        return -1;
+    }
+
+    snprintf(comando, sizeof(comando), "exec ssh -o BatchMode=yes -o ConnectTimeout=%d %s", PRAZO_ALVO_SEGUNDOS, palavrasSsh);
+    *pid = iniciaProcessoFilho(comando, descritor);
+    return *pid < 0 ? -1 : 0;
+}
+/*---------------------------------------------------------*/
+// Transporte por socket Unix: envia o comando a um agente ('--agente'), que devolve a saida
+static int iniciaAlvoUnix(const char *alvo, int argc, char *argv[], pid_t *pid, int *descritor){
+    struct sockaddr_un endereco = {0};
+    char linha[1024];
+    size_t usados = 0;
+
+    alvo += strlen("unix:");
+    if (strlen(alvo) >= sizeof(endereco.sun_path)){
+        return -1;
+    }
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, alvo);
+
+    // As palavras vao entre aspas duplas, no formato que a linha de comando entende
+    for (int i = 0; i < argc; i++){
+        if (strchr(argv[i], '"') != NULL || usados + strlen(argv[i]) + 4 >= sizeof(linha)){
+            return -1;
+        }
+        usados += (size_t)sprintf(linha + usados, "%s\"%s\"", i > 0 ? " " : "", argv[i]);
+    }
+    linha[usados++] = '\n';
+
+    int conexao = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conexao < 0){
+        return -1;
+    }
+    if (connect(conexao, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 || dprintf(conexao, "%.*s", (int)usados, linha) != (int)usados){
+        close(conexao);
+        return -1;
+    }
+
+    *pid = -1;
+    *descritor = conexao;
+    return 0;
+}
+
+static const TransporteAlvo transportes[] = {
+    {"local", "local", iniciaAlvoLocal},
+    {"unix:", "unix",  iniciaAlvoUnix},
+    {"",      "ssh",   iniciaAlvoSsh},
+};
+/*---------------------------------------------------------*/
+// Escolhe o transporte pelo formato do alvo; o ultimo da tabela aceita qualquer nome
+static const TransporteAlvo *transporteDoAlvo(const char *alvo){
+    for (size_t i = 0; i < sizeof(transportes) / sizeof(transportes[0]); i++){
+        size_t tamanho = strlen(transportes[i].prefixo);
+        if (strncmp(alvo, transportes[i].prefixo, tamanho) == 0 && (tamanho == 0 || transportes[i].prefixo[tamanho - 1] == ':' || alvo[tamanho] == '\0')){
+            return &transportes[i];
+        }
+    }
+    return NULL;
+}
+/*---------------------------------------------------------*/
+// Le a lista de alvos, separados por virgula ou, com "@arquivo", um por linha
+static int leListaDeAlvos(const char *lista, ExecucaoAlvo *alvos, int maximo){
+    char texto[8192];
+    int quantidade = 0;
+
+    if (lista[0] == '@'){
+        FILE *arquivo = fopen(lista + 1, "r");
+        if (arquivo == NULL){
+            printf("> Nao foi possivel abrir a lista de alvos '%s': %s\n", lista + 1, strerror(errno));
+            return -1;
+        }
+        size_t lidos = fread(texto, 1, sizeof(texto) - 1, arquivo);
+        int sobrou = fgetc(arquivo) != EOF;
+        texto[lidos] = '\0';
+        fclose(arquivo);
+
+        // Uma lista cortada no meio executaria o comando so em parte dos alvos
+        if (sobrou){
+            printf("> A lista de alvos '%s' passa de %d bytes!\n", lista + 1, (int)sizeof(texto) - 1);
+            return -1;
+        }
+    } else {
+        snprintf(texto, sizeof(texto), "%s", lista);
+    }
+
+    for (char *alvo = strtok(texto, ",\n\r"); alvo != NULL; alvo = strtok(NULL, ",\n\r")){
+        while (*alvo == ' ' || *alvo == '\t'){
+            alvo++;
+        }
+        if (*alvo == '\0' || *alvo == '#'){
+            continue;
+        }
+        if (quantidade == maximo){
+            printf("> A lista passa do maximo de %d alvos!\n", maximo);
+            return -1;
+        }
+        memset(&alvos[quantidade], 0, sizeof(ExecucaoAlvo));
+        snprintf(alvos[quantidade].nome, sizeof(alvos[quantidade].nome), "%s", alvo);
+        alvos[quantidade].nome[strcspn(alvos[quantidade].nome, " \t")] = '\0';
+        alvos[quantidade].transporte = transporteDoAlvo(alvos[quantidade].nome);
+        alvos[quantidade].descritor = -1;
+        alvos[quantidade].estado = -1;
+        quantidade++;
+    }
+    return quantidade;
+}
+/*---------------------------------------------------------*/
+// Guarda um bloco lido do alvo. A saida tem limite, mas os ultimos bytes sao
+// guardados a parte para que a marca final do agente nao se perca no corte.
+static void acrescentaSaidaDoAlvo(ExecucaoAlvo *alvo, const char *bloco, size_t tamanho){
+    acrescentaBuffer(&alvo->saida, bloco, tamanho, LIMITE_SAIDA_ALVO);
+    alvo->recebidos += tamanho;
+
+    if (tamanho >= sizeof(alvo->ultimos)){
+        memcpy(alvo->ultimos, bloco + tamanho - sizeof(alvo->ultimos), sizeof(alvo->ultimos));
+        alvo->tamanhoUltimos = sizeof(alvo->ultimos);
+        return;
+    }
+    size_t mantidos = alvo->tamanhoUltimos + tamanho > sizeof(alvo->ultimos) ? sizeof(alvo->ultimos) - tamanho : alvo->tamanhoUltimos;
+    memmove(alvo->ultimos, alvo->ultimos + alvo->tamanhoUltimos - mantidos, mantidos);
+    memcpy(alvo->ultimos + mantidos, bloco, tamanho);
+    alvo->tamanhoUltimos = mantidos + tamanho;
+}
+/*---------------------------------------------------------*/
+// Recolhe sem bloquear o filho de um alvo cuja saida ja terminou; retorna 1 se ele ja saiu
+static int recolheAlvo(ExecucaoAlvo *alvo){
+    int status;
+
+    if (waitpid(alvo->pid, &status, WNOHANG) != alvo->pid){
+        return 0;
+    }
+    alvo->estado = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    alvo->pid = 0;
+    return 1;
+}
+/*---------------------------------------------------------*/
+// Fecha um alvo que terminou, obtendo o codigo de saida do filho ou a marca final do agente
+static void finalizaAlvo(ExecucaoAlvo *alvo, int situacao, double agora){
+    if (alvo->descritor >= 0){
+        close(alvo->descritor);
+        alvo->descritor = -1;
+    }
+    alvo->duracao = agora - alvo->inicio;
+    alvo->situacao = situacao;
+
+    if (alvo->pid > 0){
+        // Um filho ainda nao recolhido so chega aqui no fim do prazo; depois do SIGKILL a espera e curta
+        int status;
+        kill(-alvo->pid, SIGKILL);
+        waitpid(alvo->pid, &status, 0);
+        alvo->estado = -1;
+        alvo->pid = 0;
+    } else if (alvo->pid < 0 && alvo->tamanhoUltimos > 0){
+        char *marca = memrchr(alvo->ultimos, MARCA_FIM_AGENTE, alvo->tamanhoUltimos);
+        if (marca != NULL){
+            alvo->estado = atoi(marca + 1);
+
+            // A marca so e retirada da saida guardada quando ela nao foi cortada
+            size_t posicao = alvo->recebidos - alvo->tamanhoUltimos + (size_t)(marca - alvo->ultimos);
+            if (alvo->recebidos == alvo->saida.tamanho){
+                alvo->saida.tamanho = posicao;
+            }
+        }
+    }
+
+    if (situacao == ALVO_OK && alvo->estado != 0){
+        alvo->situacao = ALVO_FALHOU;
+    }
+}
+/*---------------------------------------------------------*/
+// Imprime a linha de um alvo na tabela, com a primeira linha relevante da saida
+static void imprimeLinhaDoAlvo(const ExecucaoAlvo *alvo){
+    static const char *situacoes[] = {"espera", "rodando", "ok", "falhou", "prazo", "erro"};
+    const char *resumo = "";
+    int tamanhoResumo = 0;
+    const char *leitura = alvo->saida.dados;
+    const char *fim = leitura + alvo->saida.tamanho;
+
+    // Pula a divisao e as linhas vazias que o programa imprime antes da saida do comando
+    while (leitura != NULL && leitura < fim){
+        const char *quebra = memchr(leitura, '\n', (size_t)(fim - leitura));
+        int tamanho = (int)((quebra != NULL ? quebra : fim) - leitura);
+        if (tamanho > 0 && leitura[0] != '-'){
+            resumo = leitura;
+            tamanhoResumo = tamanho < 40 ? tamanho : 40;
+            break;
+        }
+        leitura = quebra != NULL ? quebra + 1 : NULL;
+    }
+
+    printf("  %-24.24s %-6s %-8s %6d %7.1fs  %.*s\n", alvo->nome, alvo->transporte != NULL ? alvo->transporte->nome : "?",
+           situacoes[alvo->situacao], alvo->estado, alvo->duracao, tamanhoResumo, resumo);
+    fflush(stdout);
+}
+#endif
+/*---------------------------------------------------------*/
+// Executa um comando em varios computadores ao mesmo tempo e junta os resultados em uma tabela
+int executarEmVarios(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    char lista[2048];
+    char comando[512];
+    char *palavras[32];
+    ExecucaoAlvo *alvos = malloc(MAX_ALVOS * sizeof(ExecucaoAlvo));
+
+    if (alvos == NULL){
+        return -1;
+    }
+
+    if (obtemTexto(argc, argv, 0, "Digite os alvos separados por virgula (local, unix:/caminho, maquina ou usuario@maquina) ou @arquivo:",
+                   lista, sizeof(lista)) != 0){
+        printf("> Lista de alvos invalida!\n");
+        free(alvos);
+        return -1;
+    }
+    if (obtemLinha(argc, argv, 1, "Digite o comando a executar (por exemplo, rede ip):", comando, sizeof(comando)) != 0){
+        printf("> Comando invalido!\n");
+        free(alvos);
+        return -1;
+    }
+
+    // O comando e conferido aqui, para que um erro de digitacao nao seja enviado a todos os alvos
+    int numPalavras = separaPalavras(comando, palavras, 32);
+    const Acao *acao = numPalavras >= 2 ? buscaAcao(palavras[0], palavras[1]) : NULL;
+    if (!acaoRemotaPermitida(acao)){
+        printf("> Comando invalido! Digite-o como na linha de comando, por exemplo 'rede ip'.\n");
+        free(alvos);
+        return -1;
+    }
+
+    // Os alvos recebem os nomes completos, pois um prefixo unico aqui pode nao ser unico em outra versao
+    palavras[0] = (char *)acao->caminho;
+    palavras[1] = (char *)acao->nome;
+
+    int numAlvos = leListaDeAlvos(lista, alvos, MAX_ALVOS);
+    if (numAlvos <= 0){
+        if (numAlvos == 0){
+            printf("> Nenhum alvo informado!\n");
+        }
+        free(alvos);
+        return -1;
+    }
+
+    printf("> Executando '%s %s' em %d alvo(s), ate %d ao mesmo tempo, com prazo de %d segundos...\n\n",
+           acao->caminho, acao->nome, numAlvos, MAX_ALVOS_PARALELOS, PRAZO_ALVO_SEGUNDOS);
+    printf("  %-24s %-6s %-8s %6s %8s  %s\n", "ALVO", "VIA", "ESTADO", "CODIGO", "TEMPO", "SAIDA");
+    fflush(stdout);
+
+    int proximo = 0;
+    int rodando = 0;
+    int concluidos = 0;
+    int falhas = 0;
+    double inicio = tempoAtual();
+
+    while (concluidos < numAlvos){
+        // Inicia novos alvos enquanto houver vaga no grupo de execucao
+        while (rodando < MAX_ALVOS_PARALELOS && proximo < numAlvos){
+            ExecucaoAlvo *alvo = &alvos[proximo++];
+            alvo->inicio = tempoAtual();
+            if (alvo->transporte == NULL || alvo->transporte->inicia(alvo->nome, numPalavras, palavras, &alvo->pid, &alvo->descritor) != 0){
+                alvo->situacao = ALVO_ERRO;
+                alvo->descritor = -1;
+                imprimeLinhaDoAlvo(alvo);
+                concluidos++;
+                falhas++;
+                continue;
+            }
+            alvo->situacao = ALVO_RODANDO;
+            rodando++;
+        }
+        if (rodando == 0){
+            continue;
+        }
+
+        struct pollfd eventos[MAX_ALVOS_PARALELOS];
+        int indices[MAX_ALVOS_PARALELOS];
+        int numEventos = 0;
+        int aguardandoSaida = 0;
+        double agora = tempoAtual();
+        double proximoPrazo = -1;
+
+        // Alvos com a saida ja fechada continuam no laco ate o filho sair ou o prazo acabar
+        for (int i = 0; i < proximo; i++){
+            if (alvos[i].situacao != ALVO_RODANDO){
+                continue;
+            }
+            double prazo = alvos[i].inicio + PRAZO_ALVO_SEGUNDOS;
+            if (proximoPrazo < 0 || prazo < proximoPrazo){
+                proximoPrazo = prazo;
+            }
+            if (alvos[i].descritor < 0){
+                aguardandoSaida = 1;
+                continue;
+            }
+            eventos[numEventos].fd = alvos[i].descritor;
+            eventos[numEventos].events = POLLIN;
+            indices[numEventos++] = i;
+        }
+
+        int espera = proximoPrazo > agora ? (int)((proximoPrazo - agora) * 1000) + 1 : 0;
+        if (aguardandoSaida && espera > 20){
+            espera = 20;
+        }
+        if (poll(eventos, numEventos, espera) < 0 && errno != EINTR){
+            break;
+        }
+
+        for (int k = 0; k < numEventos; k++){
+            ExecucaoAlvo *alvo = &alvos[indices[k]];
+
+            if (eventos[k].revents & (POLLIN | POLLHUP | POLLERR)){
+                char bloco[65536];
+                ssize_t lidos = read(alvo->descritor, bloco, sizeof(bloco));
+                if (lidos > 0){
+                    acrescentaSaidaDoAlvo(alvo, bloco, (size_t)lidos);
+                } else if (lidos == 0 || errno != EINTR){
+                    close(alvo->descritor);
+                    alvo->descritor = -1;
+                }
+            }
+        }
+
+        agora = tempoAtual();
+        for (int i = 0; i < proximo; i++){
+            ExecucaoAlvo *alvo = &alvos[i];
+            int situacao = ALVO_RODANDO;
+
+            if (alvo->situacao != ALVO_RODANDO){
+                continue;
+            }
+            if (alvo->descritor < 0 && (alvo->pid < 0 || recolheAlvo(alvo))){
+                situacao = ALVO_OK;
+            } else if (agora >= alvo->inicio + PRAZO_ALVO_SEGUNDOS){
+                situacao = ALVO_PRAZO;
+            }
+
+            if (situacao != ALVO_RODANDO){
+                finalizaAlvo(alvo, situacao, agora);
+                imprimeLinhaDoAlvo(alvo);
+                falhas += alvo->situacao != ALVO_OK;
+                concluidos++;
+                rodando--;
+            }
+        }
+    }
+
+    // Depois da tabela, a saida completa de cada alvo com o nome dele no inicio de cada linha
+    printf("\n> %d de %d alvo(s) com sucesso em %.1f segundos. Saidas:\n", numAlvos - falhas, numAlvos, tempoAtual() - inicio);
+    for (int i = 0; i < numAlvos; i++){
+        const char *leitura = alvos[i].saida.dados;
+        const char *fim = leitura + alvos[i].saida.tamanho;
+
+        while (leitura != NULL && leitura < fim){
+            const char *quebra = memchr(leitura, '\n', (size_t)(fim - leitura));
+            int tamanho = (int)((quebra != NULL ? quebra : fim) - leitura);
+            if (tamanho > 0){
+                printf("[%s] %.*s\n", alvos[i].nome, tamanho, leitura);
+            }
+            leitura = quebra != NULL ? quebra + 1 : NULL;
+        }
+        free(alvos[i].saida.dados);
+    }
+
+    free(alvos);
+    return falhas == 0 ? 0 : -1;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Atende uma conexao do agente: le o comando, executa o programa com a saida no socket e envia o codigo final
+#ifdef __linux__
+static void atendeConexaoDoAgente(int conexao){
+    char linha[1024];
+    char *palavras[34];
+    char caminho[MAX_CAMINHO];
+    size_t usados = 0;
+    double prazo = tempoAtual() + 5;
+
+    // O comando vem em uma unica linha; um cliente que nao a envia a tempo e descartado
+    while (usados + 1 < sizeof(linha) && memchr(linha, '\n', usados) == NULL){
+        struct pollfd espera = {conexao, POLLIN, 0};
+        int restante = (int)((prazo - tempoAtual()) * 1000);
+        if (restante <= 0 || poll(&espera, 1, restante) <= 0){
+            return;
+        }
+        ssize_t lidos = read(conexao, linha + usados, sizeof(linha) - 1 - usados);
+        if (lidos <= 0){
+            return;
+        }
+        usados += (size_t)lidos;
+    }
+    linha[usados] = '\0';
+    linha[strcspn(linha, "\r\n")] = '\0';
+
+    // O agente confere o comando por conta propria: um cliente qualquer pode falar com o socket
+    int numPalavras = separaPalavras(linha, palavras + 1, 32);
+    const Acao *acao = numPalavras >= 2 ? buscaAcao(palavras[1], palavras[2]) : NULL;
+    if (!acaoRemotaPermitida(acao) || caminhoDoExecutavel(caminho, sizeof(caminho)) != 0){
+        dprintf(conexao, "> Comando invalido!\n%c%d\n", MARCA_FIM_AGENTE, 2);
+        return;
+    }
+    palavras[0] = "comandos";
+    palavras[numPalavras + 1] = NULL;
+
+    pid_t pid = fork();
+    if (pid == 0){
+        int nulo = open("/dev/null", O_RDONLY);
+        if (nulo >= 0){
+            dup2(nulo, STDIN_FILENO);
+            close(nulo);
+        }
+        dup2(conexao, STDOUT_FILENO);
+        dup2(conexao, STDERR_FILENO);
+        close(conexao);
+        setpgid(0, 0);
+        execv(caminho, palavras);
+        _exit(127);
+    }
+    if (pid < 0){
+        dprintf(conexao, "\n%c%d\n", MARCA_FIM_AGENTE, 127);
+        return;
+    }
+    setpgid(pid, pid);
+
+    // A espera acompanha o fim do filho (pelo pidfd) e o fechamento da conexao pelo cliente, com o mesmo prazo dele
+    int pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+    double prazoExecucao = tempoAtual() + PRAZO_ALVO_SEGUNDOS;
+    int status = 0;
+    int encerrado = 0;
+
+    while (waitpid(pid, &status, WNOHANG) == 0){
+        struct pollfd espera[2] = {{conexao, POLLRDHUP, 0}, {pidfd, POLLIN, 0}};
+        int restante = (int)((prazoExecucao - tempoAtual()) * 1000) + 1;
+
+        if (pidfd < 0 && restante > 50){
+            restante = 50;
+        }
+        if (restante <= 0 || (poll(espera, pidfd >= 0 ? 2 : 1, restante) > 0 && (espera[0].revents & (POLLRDHUP | POLLHUP | POLLERR)))){
+            kill(-pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            encerrado = 1;
+            break;
+        }
+    }
+    if (pidfd >= 0){
+        close(pidfd);
+    }
+
+    if (encerrado){
+        dprintf(conexao, "\n> Prazo esgotado ou conexao fechada; comando encerrado.\n%c%d\n", MARCA_FIM_AGENTE, -1);
+        return;
+    }
+    dprintf(conexao, "\n%c%d\n", MARCA_FIM_AGENTE, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+}
+#endif
+/*---------------------------------------------------------*/
+// Modo agente: atende comandos recebidos por um socket Unix, um processo por conexao
+int executarAgente(const char *caminho){
+#ifdef __linux__
+    struct sockaddr_un endereco = {0};
+
+    if (caminho == NULL || strlen(caminho) >= sizeof(endereco.sun_path)){
+        printf("> Informe o caminho do socket: --agente /caminho/do/socket\n");
+        return 1;
+    }
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+
+    // Somente um socket que ficou de uma execucao anterior e removido; qualquer outro arquivo e preservado
+    struct stat existente;
+    if (lstat(caminho, &existente) == 0){
+        if (!S_ISSOCK(existente.st_mode)){
+            printf("> '%s' ja existe e nao e um socket; escolha outro caminho.\n", caminho);
+            return 1;
+        }
+        unlink(caminho);
+    }
+
+    int servidor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    // Somente o proprio usuario pode conectar ao socket
+    mode_t mascara = umask(077);
+    int ligado = servidor >= 0 && bind(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) == 0;
+    umask(mascara);
+    if (!ligado || listen(servidor, 16) != 0){
+        printf("> Nao foi possivel abrir o socket '%s': %s\n", caminho, strerror(errno));
+        if (servidor >= 0){
+            close(servidor);
+        }
+        return 1;
+    }
+
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = interrompeAgente;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    // Os processos de cada conexao sao recolhidos automaticamente
+    acao.sa_handler = SIG_IGN;
+    sigaction(SIGCHLD, &acao, NULL);
+
+    printf("> Agente aguardando comandos em '%s' (Ctrl+C para encerrar)...\n", caminho);
+    fflush(stdout);
+
+    while (agenteAtivo){
+        int conexao = accept4(servidor, NULL, NULL, SOCK_CLOEXEC);
+        if (conexao < 0){
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0){
+            close(servidor);
+            acao.sa_handler = SIG_DFL;
+            sigaction(SIGCHLD, &acao, NULL);
+            atendeConexaoDoAgente(conexao);
+            close(conexao);
+            _exit(0);
+        }
+        close(conexao);
+    }
+
+    close(servidor);
+    unlink(caminho);
+    printf("> Agente encerrado.\n");
+    return 0;
+#else
+    printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
+    return 1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes auxiliares dos sinais vitais em memoria compartilhada
+//
+// O amostrador ('--amostrador') le o /proc em intervalo fixo e publica uma
+// estrutura de layout fixo em um segmento POSIX de memoria compartilhada,
+// protegida por um seqlock: o contador de sequencia fica impar enquanto os
+// dados estao sendo escritos. Os leitores copiam os dados e repetem a copia
+// se a sequencia mudou ou estava impar, sem nenhuma chamada de sistema.
+#define SINAIS_VITAIS_SEGMENTO "/comandos_sinais_vitais"
+#define SINAIS_VITAIS_VERSAO 1
+#define SINAIS_VITAIS_INTERVALO_PADRAO 1000
+
+enum { CPU_USUARIO, CPU_NICE, CPU_SISTEMA, CPU_OCIOSO, CPU_IOWAIT, CPU_IRQ, CPU_SOFTIRQ, CPU_STEAL, NUM_TEMPOS_CPU };
+
+typedef struct {
+    int64_t instante;
+    uint64_t amostras;
+    double carga[3];
+    uint32_t executando;
+    uint32_t totalProcessos;
+    uint64_t cpu[NUM_TEMPOS_CPU];
+    uint64_t memoriaTotal;
+    uint64_t memoriaLivre;
+    uint64_t memoriaDisponivel;
+    uint64_t buffers;
+    uint64_t cache;
+    uint64_t swapTotal;
+    uint64_t swapLivre;
+    uint64_t bytesRecebidos;
+    uint64_t pacotesRecebidos;
+    uint64_t bytesEnviados;
+    uint64_t pacotesEnviados;
+} SinaisVitais;
+
+// A sequencia e os dados ficam em linhas de cache separadas para que a escrita
+// do contador nao invalide a linha que os leitores estao copiando
+typedef struct {
+    _Alignas(64) _Atomic uint32_t sequencia;
+    uint32_t versao;
+    uint32_t intervaloMs;
+    int32_t pidAmostrador;
+    _Alignas(64) SinaisVitais dados;
+} SegmentoSinaisVitais;
+
+#ifdef __linux__
+static volatile sig_atomic_t amostradorAtivo = 1;
+/*---------------------------------------------------------*/
+// Encerra o laco do amostrador ao receber SIGINT ou SIGTERM
+static void interrompeAmostrador(int sinal){
+    (void)sinal;
+    amostradorAtivo = 0;
+}
+/*---------------------------------------------------------*/
+// Le um arquivo do /proc ja aberto desde o inicio, sem reabri-lo
+static ssize_t leArquivoProc(int descritor, char *buffer, size_t tamanho){
+    ssize_t lidos = pread(descritor, buffer, tamanho - 1, 0);
+    buffer[lidos > 0 ? lidos : 0] = '\0';
+    return lidos;
+}
+/*---------------------------------------------------------*/
+// Extrai um campo em kB do /proc/meminfo
+static uint64_t campoMeminfo(const char *texto, const char *campo){
+    const char *posicao = strstr(texto, campo);
+    return posicao != NULL ? strtoull(posicao + strlen(campo), NULL, 10) : 0;
+}
+/*---------------------------------------------------------*/
+// Coleta uma amostra completa dos sinais vitais a partir dos arquivos do /proc
+static void coletaSinaisVitais(const int descritores[4], SinaisVitais *sinais){
+    char buffer[16384];
+    struct timespec agora;
+
+    clock_gettime(CLOCK_REALTIME, &agora);
+    sinais->instante = (int64_t)agora.tv_sec * 1000000000LL + agora.tv_nsec;
+
+    if (leArquivoProc(descritores[0], buffer, sizeof(buffer)) > 0){
+        sscanf(buffer, "%lf %lf %lf %u/%u", &sinais->carga[0], &sinais->carga[1], &sinais->carga[2],
+               &sinais->executando, &sinais->totalProcessos);
+    }
+
+    if (leArquivoProc(descritores[1], buffer, sizeof(buffer)) > 0){
+        unsigned long long cpu[NUM_TEMPOS_CPU] = {0};
+        sscanf(buffer, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &cpu[CPU_USUARIO], &cpu[CPU_NICE],
+               &cpu[CPU_SISTEMA], &cpu[CPU_OCIOSO], &cpu[CPU_IOWAIT], &cpu[CPU_IRQ], &cpu[CPU_SOFTIRQ], &cpu[CPU_STEAL]);
+        for (int i = 0; i < NUM_TEMPOS_CPU; i++){
+            sinais->cpu[i] = (uint64_t)cpu[i];
+        }
+    }
+
+    if (leArquivoProc(descritores[2], buffer, sizeof(buffer)) > 0){
+        sinais->memoriaTotal = campoMeminfo(buffer, "MemTotal:");
+        sinais->memoriaLivre = campoMeminfo(buffer, "MemFree:");
+        sinais->memoriaDisponivel = campoMeminfo(buffer, "MemAvailable:");
+        sinais->buffers = campoMeminfo(buffer, "Buffers:");
+        sinais->cache = campoMeminfo(buffer, "\nCached:");
+        sinais->swapTotal = campoMeminfo(buffer, "SwapTotal:");
+        sinais->swapLivre = campoMeminfo(buffer, "SwapFree:");
+    }
+
+    if (leArquivoProc(descritores[3], buffer, sizeof(buffer)) > 0){
+        char *contexto;
+        sinais->bytesRecebidos = sinais->pacotesRecebidos = 0;
+        sinais->bytesEnviados = sinais->pacotesEnviados = 0;
+
+        // As duas primeiras linhas sao cabecalho; a interface de loopback e ignorada
+        for (char *linha = strtok_r(buffer, "\n", &contexto); linha != NULL; linha = strtok_r(NULL, "\n", &contexto)){
+            char *separador = strchr(linha, ':');
+            unsigned long long valores[16];
+
+            if (separador == NULL){
+                continue;
+            }
+            *separador = '\0';
+            while (*linha == ' '){
+                linha++;
+            }
+            if (strcmp(linha, "lo") == 0){
+                continue;
+            }
+            if (sscanf(separador + 1, "%llu %llu %*u %*u %*u %*u %*u %*u %llu %llu", &valores[0], &valores[1], &valores[8], &valores[9]) == 4){
+                sinais->bytesRecebidos += valores[0];
+                sinais->pacotesRecebidos += valores[1];
+                sinais->bytesEnviados += valores[8];
+                sinais->pacotesEnviados += valores[9];
+            }
+        }
+    }
+}
+/*---------------------------------------------------------*/
+// Publica uma amostra no segmento compartilhado sob o seqlock
+static void publicaSinaisVitais(SegmentoSinaisVitais *segmento, const SinaisVitais *sinais){
+    uint32_t sequencia = atomic_load_explicit(&segmento->sequencia, memory_order_relaxed);
+
+    atomic_store_explicit(&segmento->sequencia, sequencia + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&segmento->dados, sinais, sizeof(SinaisVitais));
+    atomic_store_explicit(&segmento->sequencia, sequencia + 2, memory_order_release);
+}
+/*---------------------------------------------------------*/
+// Copia uma amostra consistente do segmento compartilhado, repetindo se houver escrita simultanea
+static void leSinaisVitais(const SegmentoSinaisVitais *segmento, SinaisVitais *sinais){
+    uint32_t inicio;
+    uint32_t fim;
+
+    do {
+        inicio = atomic_load_explicit((_Atomic uint32_t *)&segmento->sequencia, memory_order_acquire);
+        memcpy(sinais, &segmento->dados, sizeof(SinaisVitais));
+        atomic_thread_fence(memory_order_acquire);
+        fim = atomic_load_explicit((_Atomic uint32_t *)&segmento->sequencia, memory_order_relaxed);
+    } while ((inicio & 1) || inicio != fim);
+}
+/*---------------------------------------------------------*/
+// Mapeia o segmento dos sinais vitais apenas para leitura
+static const SegmentoSinaisVitais *abreSegmentoSinaisVitais(){
+    int descritor = shm_open(SINAIS_VITAIS_SEGMENTO, O_RDONLY, 0);
+    if (descritor < 0){
+        return NULL;
+    }
+
+    struct stat informacoes;
+    if (fstat(descritor, &informacoes) != 0 || informacoes.st_size < (off_t)sizeof(SegmentoSinaisVitais)){
+        close(descritor);
+        return NULL;
+    }
+
+    void *mapa = mmap(NULL, sizeof(SegmentoSinaisVitais), PROT_READ, MAP_SHARED, descritor, 0);
+    close(descritor);
+    if (mapa == MAP_FAILED){
+        return NULL;
+    }
+
+    const SegmentoSinaisVitais *segmento = mapa;
+    if (segmento->versao != SINAIS_VITAIS_VERSAO){
+        munmap(mapa, sizeof(SegmentoSinaisVitais));
+        return NULL;
+    }
+    return segmento;
+}
+/*---------------------------------------------------------*/
+// Diz se o amostrador ainda roda; EPERM significa que ele existe, mas e de outro usuario
+static int amostradorVivo(pid_t pid){
+    return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+#endif
+/*---------------------------------------------------------*/
+// Executa o modo amostrador, publicando os sinais vitais ate receber SIGINT/SIGTERM
+int executarAmostrador(int intervaloMs){
+#ifdef __linux__
+    const char *arquivos[4] = {"/proc/loadavg", "/proc/stat", "/proc/meminfo", "/proc/net/dev"};
+    int descritores[4];
+    SinaisVitais sinais;
+
+    if (intervaloMs <= 0){
+        intervaloMs = SINAIS_VITAIS_INTERVALO_PADRAO;
+    }
+
+    const SegmentoSinaisVitais *existente = abreSegmentoSinaisVitais();
+    if (existente != NULL){
+        pid_t pid = existente->pidAmostrador;
+        munmap((void *)existente, sizeof(SegmentoSinaisVitais));
+        if (amostradorVivo(pid)){
+            fprintf(stderr, "> Ja existe um amostrador em execucao (pid %d)!\n", (int)pid);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < 4; i++){
+        descritores[i] = open(arquivos[i], O_RDONLY);
+        if (descritores[i] < 0){
+            fprintf(stderr, "> Nao foi possivel abrir '%s'!\n", arquivos[i]);
+            return 1;
+        }
+    }
+
+    // Qualquer usuario pode ler o segmento (os dados ja sao publicos no /proc), mas so o dono escreve.
+    // Um segmento antigo so e reaproveitado se for do proprio usuario e ninguem mais puder altera-lo
+    int descritor = shm_open(SINAIS_VITAIS_SEGMENTO, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (descritor >= 0){
+        fchmod(descritor, 0644);
+    } else if (errno == EEXIST){
+        struct stat informacoes;
+        descritor = shm_open(SINAIS_VITAIS_SEGMENTO, O_RDWR, 0);
+        if (descritor >= 0 && (fstat(descritor, &informacoes) != 0 || informacoes.st_uid != geteuid() ||
+                               (informacoes.st_mode & 022) != 0)){
+            fprintf(stderr, "> O segmento '%s' pertence a outro usuario ou pode ser alterado por outros!\n", SINAIS_VITAIS_SEGMENTO);
+            close(descritor);
+            return 1;
+        }
+    }
+    if (descritor < 0 || ftruncate(descritor, sizeof(SegmentoSinaisVitais)) != 0){
+        fprintf(stderr, "> Nao foi possivel criar o segmento '%s'!\n", SINAIS_VITAIS_SEGMENTO);
+        if (descritor >= 0){
+            close(descritor);
+        }
+        return 1;
+    }
+
+    SegmentoSinaisVitais *segmento = mmap(NULL, sizeof(SegmentoSinaisVitais), PROT_READ | PROT_WRITE, MAP_SHARED, descritor, 0);
+    close(descritor);
+    if (segmento == MAP_FAILED){
+        fprintf(stderr, "> Nao foi possivel mapear o segmento '%s'!\n", SINAIS_VITAIS_SEGMENTO);
+        return 1;
+    }
+
+    memset(&sinais, 0, sizeof(sinais));
+    atomic_store_explicit(&segmento->sequencia, 0, memory_order_relaxed);
+    segmento->intervaloMs = (uint32_t)intervaloMs;
+    segmento->pidAmostrador = (int32_t)getpid();
+    atomic_thread_fence(memory_order_release);
+    segmento->versao = SINAIS_VITAIS_VERSAO;
+
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = interrompeAmostrador;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    printf("> Publicando sinais vitais em '%s' a cada %d ms (Ctrl+C para encerrar)...\n", SINAIS_VITAIS_SEGMENTO, intervaloMs);
+    fflush(stdout);
+
+    // O proximo instante e absoluto para que o intervalo nao acumule atraso
+    struct timespec proximo;
+    clock_gettime(CLOCK_MONOTONIC, &proximo);
+
+    while (amostradorAtivo){
+        coletaSinaisVitais(descritores, &sinais);
+        sinais.amostras++;
+        publicaSinaisVitais(segmento, &sinais);
+
+        proximo.tv_nsec += (long)(intervaloMs % 1000) * 1000000L;
+        proximo.tv_sec += intervaloMs / 1000 + proximo.tv_nsec / 1000000000L;
+        proximo.tv_nsec %= 1000000000L;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &proximo, NULL);
+    }
+
+    for (int i = 0; i < 4; i++){
+        close(descritores[i]);
+    }
+    munmap(segmento, sizeof(SegmentoSinaisVitais));
+    shm_unlink(SINAIS_VITAIS_SEGMENTO);
+    printf("> Amostrador finalizado com sucesso!\n");
+    return 0;
+#else
+    (void)intervaloMs;
+    printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
+    return 1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Desenha um quadro com os sinais vitais calculados entre duas amostras, retornando as linhas usadas
+#ifdef __linux__
+static int desenhaSinaisVitais(const SegmentoSinaisVitais *segmento, const SinaisVitais *anterior, const SinaisVitais *atual){
+    char linhas[8][160];
+    int numLinhas = 0;
+
+    uint64_t total = 0;
+    for (int i = 0; i < NUM_TEMPOS_CPU; i++){
+        total += atual->cpu[i] - anterior->cpu[i];
+    }
+    uint64_t ocioso = (atual->cpu[CPU_OCIOSO] - anterior->cpu[CPU_OCIOSO]) + (atual->cpu[CPU_IOWAIT] - anterior->cpu[CPU_IOWAIT]);
+    double segundos = (atual->instante - anterior->instante) / 1e9;
+    struct timespec agora;
+    clock_gettime(CLOCK_REALTIME, &agora);
+    double idade = ((int64_t)agora.tv_sec * 1000000000LL + agora.tv_nsec - atual->instante) / 1e9;
+
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "> Sinais Vitais (amostra %llu, pid %d, ha %.1f s)",
+             (unsigned long long)atual->amostras, (int)segmento->pidAmostrador, idade);
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "  Carga media:  %.2f %.2f %.2f (%u/%u processos)",
+             atual->carga[0], atual->carga[1], atual->carga[2], atual->executando, atual->totalProcessos);
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "  CPU:          %.1f%% em uso", total > 0 ? 100.0 * (total - ocioso) / total : 0.0);
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "  Memoria:      %llu MB disponiveis de %llu MB (livre %llu MB, cache %llu MB)",
+             (unsigned long long)atual->memoriaDisponivel / 1024, (unsigned long long)atual->memoriaTotal / 1024,
+             (unsigned long long)atual->memoriaLivre / 1024, (unsigned long long)(atual->cache + atual->buffers) / 1024);
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "  Swap:         %llu MB livres de %llu MB",
+             (unsigned long long)atual->swapLivre / 1024, (unsigned long long)atual->swapTotal / 1024);
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "  Rede:         recebido %.1f KB/s, enviado %.1f KB/s",
+             segundos > 0 ? (atual->bytesRecebidos - anterior->bytesRecebidos) / 1024.0 / segundos : 0.0,
+             segundos > 0 ? (atual->bytesEnviados - anterior->bytesEnviados) / 1024.0 / segundos : 0.0);
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "%s", idade > 3.0 * segmento->intervaloMs / 1000.0 ?
+             "> Atencao: a amostra esta desatualizada, o amostrador pode ter sido encerrado." : "");
+    snprintf(linhas[numLinhas++], sizeof(linhas[0]), "> Pressione Enter para voltar ao menu.");
+
+    telaNovoQuadro();
+    for (int i = 0; i < numLinhas; i++){
+        telaEscreve(i, 0, linhas[i], i == 0 ? ATRIBUTO_INVERTIDO : 0);
+    }
+    telaApresenta();
+    return numLinhas;
+}
+#endif
+/*---------------------------------------------------------*/
+// Exibe ao vivo os sinais vitais publicados pelo amostrador na memoria compartilhada
+int verSinaisVitais(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    const SegmentoSinaisVitais *segmento = abreSegmentoSinaisVitais();
+    SinaisVitais anterior;
+    SinaisVitais atual;
+    int linhasUsadas;
+
+    if (segmento == NULL){
+        printf("> Nenhum amostrador em execucao. Inicie um com '--amostrador [intervalo_ms]'.\n");
+        return -1;
+    }
+
+    // Duas amostras consecutivas permitem calcular o uso de CPU e as taxas de rede
+    // A espera e limitada pelo relogio local, pois o conteudo de um segmento abandonado nao e confiavel
+    double intervalo = segmento->intervaloMs < 10000 ? segmento->intervaloMs / 1000.0 : 10.0;
+    double limiteEspera = tempoAtual() + 3.0 * intervalo + 0.5;
+    leSinaisVitais(segmento, &anterior);
+    do {
+        struct timespec espera = {0, 50 * 1000000L};
+        nanosleep(&espera, NULL);
+        leSinaisVitais(segmento, &atual);
+    } while (atual.amostras == anterior.amostras && atual.amostras > 0 && tempoAtual() < limiteEspera &&
+             amostradorVivo(segmento->pidAmostrador));
+
+    // Cada atualizacao reescreve apenas os numeros que mudaram, ate o usuario pressionar Enter
+    telaAcrescenta("\x1b[?25l", 6);
+    for (;;){
+        struct pollfd entrada = {STDIN_FILENO, POLLIN, 0};
+
+        linhasUsadas = desenhaSinaisVitais(segmento, &anterior, &atual);
+        if (poll(&entrada, 1, (int)segmento->intervaloMs) != 0){
+            break;
+        }
+        anterior = atual;
+        leSinaisVitais(segmento, &atual);
+    }
+    telaFinalizaQuadros(linhasUsadas);
+
+    // O Enter que encerrou a visualizacao nao pode sobrar para a proxima leitura do menu
+    if (isatty(STDIN_FILENO)){
+        tcflush(STDIN_FILENO, TCIFLUSH);
+    } else {
+        limparBuffer();
+    }
+
+    munmap((void *)segmento, sizeof(SegmentoSinaisVitais));
+    return 0;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Estruturas e funcoes auxiliares do teste de banda (servidor e cliente)
+//
+// Cada fluxo e uma conexao TCP que comeca com um CabecalhoBanda. No modo de
+// vazao o cliente envia dados ate o fim do tempo e o servidor os descarta com
+// splice() para o /dev/null, sem copiar para o espaco do usuario. No modo de
+// latencia o servidor devolve cada mensagem recebida. Ao final, o servidor
+// informa ao cliente quantos bytes recebeu naquele fluxo.
+#define BANDA_MAGICO 0x434d4442u
+#define BANDA_PORTA_PADRAO 5201
+#define BANDA_TAMANHO_BUFFER (1 << 20)
+#define BANDA_MAX_FLUXOS 64
+#define BANDA_MAX_LATENCIAS 1000000
+#define BANDA_PRAZO_CABECALHO 5
+
+enum { MODO_VAZAO = 1, MODO_LATENCIA = 2 };
+enum { METODO_COPIA = 1, METODO_SENDFILE = 2, METODO_ZEROCOPY = 3 };
+
+typedef struct {
+    uint32_t magico;
+    uint32_t modo;
+    uint32_t fluxo;
+    uint32_t numFluxos;
+    uint32_t tamanhoMensagem;
+} CabecalhoBanda;
+
+#ifdef __linux__
+typedef struct {
+    int socket;
+    int indice;
+    CabecalhoBanda cabecalho;
+    uint64_t bytes;
+    double duracao;
+    pthread_t thread;
+} ConexaoBanda;
+
+typedef struct {
+    int socket;
+    int indice;
+    int modo;
+    int metodo;
+    uint32_t tamanhoMensagem;
+    const char *buffer;
+    int memfd;
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t transacoes;
+    _Atomic int *parar;
+    double *latencias;
+    size_t numLatencias;
+    uint64_t confirmado;
+    int erro;
+    pthread_t thread;
+} FluxoBanda;
+/*---------------------------------------------------------*/
+// Fixa a thread atual em um nucleo, distribuindo os fluxos entre os nucleos disponiveis
+static void fixaNoNucleo(int indice){
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t conjunto;
+
+    if (nucleos <= 0){
+        return;
+    }
+    CPU_ZERO(&conjunto);
+    CPU_SET(indice % nucleos, &conjunto);
+    pthread_setaffinity_np(pthread_self(), sizeof(conjunto), &conjunto);
+}
+/*---------------------------------------------------------*/
+// Recebe exatamente 'tamanho' bytes, retornando -1 se a conexao terminar antes
+static int recebeTudo(int socket, void *dados, size_t tamanho){
+    char *posicao = dados;
+
+    while (tamanho > 0){
+        ssize_t lidos = recv(socket, posicao, tamanho, 0);
+        if (lidos < 0 && errno == EINTR){
+            continue;
+        }
+        if (lidos <= 0){
+            return -1;
+        }
+        posicao += lidos;
+        tamanho -= (size_t)lidos;
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Recebe exatamente o tamanho pedido ate o prazo; um cliente que para de enviar nao prende quem espera
+static int recebeTudoComPrazo(int socket, void *dados, size_t tamanho, double prazo){
+    char *posicao = dados;
+
+    while (tamanho > 0){
+        struct pollfd evento = {socket, POLLIN, 0};
+        int restante = (int)((prazo - tempoAtual()) * 1000);
+        if (restante <= 0 || poll(&evento, 1, restante) <= 0){
+            return -1;
+        }
+
+        ssize_t lidos = recv(socket, posicao, tamanho, 0);
+        if (lidos < 0 && errno == EINTR){
+            continue;
+        }
+        if (lidos <= 0){
+            return -1;
+        }
+        posicao += lidos;
+        tamanho -= (size_t)lidos;
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Envia exatamente 'tamanho' bytes
+static int enviaTudo(int socket, const void *dados, size_t tamanho){
+    const char *posicao = dados;
+
+    while (tamanho > 0){
+        ssize_t enviados = send(socket, posicao, tamanho, MSG_NOSIGNAL);
+        if (enviados < 0 && errno == EINTR){
+            continue;
+        }
+        if (enviados <= 0){
+            return -1;
+        }
+        posicao += enviados;
+        tamanho -= (size_t)enviados;
+    }
+    return 0;
+}
+/*---------------------------------------------------------*/
+// Descarta os dados recebidos no modo de vazao, usando splice() quando possivel
+static uint64_t descartaFluxo(int socket){
+    uint64_t total = 0;
+    int canal[2];
+    int nulo = open("/dev/null", O_WRONLY);
+
+    if (nulo >= 0 && pipe(canal) == 0){
+        ssize_t recebidos;
+        while ((recebidos = splice(socket, NULL, canal[1], NULL, BANDA_TAMANHO_BUFFER, SPLICE_F_MOVE | SPLICE_F_MORE)) > 0){
+            total += (uint64_t)recebidos;
+            while (recebidos > 0){
+                ssize_t descartados = splice(canal[0], NULL, nulo, NULL, (size_t)recebidos, SPLICE_F_MOVE);
+                if (descartados <= 0){
+                    break;
+                }
+                recebidos -= descartados;
+            }
+        }
+        close(canal[0]);
+        close(canal[1]);
+        close(nulo);
+        if (recebidos == 0 || errno != EINVAL){
+            return total;
+        }
+    } else if (nulo >= 0){
+        close(nulo);
+    }
+
+    // Alguns tipos de socket nao suportam splice(); nesse caso le para um buffer comum
+    char *buffer = malloc(BANDA_TAMANHO_BUFFER);
+    ssize_t recebidos;
+    if (buffer == NULL){
+        return total;
+    }
+    while ((recebidos = recv(socket, buffer, BANDA_TAMANHO_BUFFER, 0)) > 0 || (recebidos < 0 && errno == EINTR)){
+        if (recebidos > 0){
+            total += (uint64_t)recebidos;
+        }
+    }
+    free(buffer);
+    return total;
+}
+/*---------------------------------------------------------*/
+// Atende uma conexao do servidor de banda: descarta os dados ou devolve as mensagens
+static void *atendeConexaoBanda(void *argumento){
+    ConexaoBanda *conexao = argumento;
+    double inicio = tempoAtual();
+
+    fixaNoNucleo(conexao->indice);
+
+    if (conexao->cabecalho.modo == MODO_VAZAO){
+        conexao->bytes = descartaFluxo(conexao->socket);
+    } else {
+        char *mensagem = malloc(conexao->cabecalho.tamanhoMensagem);
+        int ligado = 1;
+        setsockopt(conexao->socket, IPPROTO_TCP, TCP_NODELAY, &ligado, sizeof(ligado));
+        while (mensagem != NULL && recebeTudo(conexao->socket, mensagem, conexao->cabecalho.tamanhoMensagem) == 0){
+            if (enviaTudo(conexao->socket, mensagem, conexao->cabecalho.tamanhoMensagem) != 0){
+                break;
+            }
+            conexao->bytes += conexao->cabecalho.tamanhoMensagem;
+        }
+        free(mensagem);
+    }
+
+    conexao->duracao = tempoAtual() - inicio;
+
+    // Confirma ao cliente quantos bytes chegaram neste fluxo
+    uint64_t confirmado = htobe64(conexao->bytes);
+    enviaTudo(conexao->socket, &confirmado, sizeof(confirmado));
+    close(conexao->socket);
+    return NULL;
+}
+/*---------------------------------------------------------*/
+// Envia dados continuamente ate o fim do teste, pelo metodo escolhido
+static void enviaFluxoVazao(FluxoBanda *fluxo){
+#ifdef SO_ZEROCOPY
+    int pendentesZeroCopy = 0;
+    if (fluxo->metodo == METODO_ZEROCOPY){
+        int ligado = 1;
+        if (setsockopt(fluxo->socket, SOL_SOCKET, SO_ZEROCOPY, &ligado, sizeof(ligado)) != 0){
+            fluxo->metodo = METODO_COPIA;
+        }
+    }
+#else
+    if (fluxo->metodo == METODO_ZEROCOPY){
+        fluxo->metodo = METODO_COPIA;
+    }
+#endif
+
+    while (!atomic_load_explicit(fluxo->parar, memory_order_relaxed)){
+        ssize_t enviados;
+
+        if (fluxo->metodo == METODO_SENDFILE){
+            off_t deslocamento = 0;
+            enviados = sendfile(fluxo->socket, fluxo->memfd, &deslocamento, BANDA_TAMANHO_BUFFER);
+        }
+#ifdef SO_ZEROCOPY
+        else if (fluxo->metodo == METODO_ZEROCOPY){
+            enviados = send(fluxo->socket, fluxo->buffer, BANDA_TAMANHO_BUFFER, MSG_ZEROCOPY | MSG_NOSIGNAL);
+
+            // As notificacoes de conclusao chegam pela fila de erros e precisam ser consumidas
+            if (++pendentesZeroCopy >= 64 || (enviados < 0 && errno == ENOBUFS)){
+                char controle[256];
+                struct msghdr mensagem;
+                memset(&mensagem, 0, sizeof(mensagem));
+                mensagem.msg_control = controle;
+                mensagem.msg_controllen = sizeof(controle);
+                while (recvmsg(fluxo->socket, &mensagem, MSG_ERRQUEUE | MSG_DONTWAIT) >= 0){
+                    mensagem.msg_controllen = sizeof(controle);
+                }
+                pendentesZeroCopy = 0;
+                if (enviados < 0 && errno == ENOBUFS){
+                    continue;
+                }
+            }
+        }
+#endif
+        else {
+            enviados = send(fluxo->socket, fluxo->buffer, BANDA_TAMANHO_BUFFER, MSG_NOSIGNAL);
+        }
+
+        if (enviados < 0 && errno == EINTR){
+            continue;
+        }
+        if (enviados <= 0){
+            fluxo->erro = 1;
+            return;
+        }
+        atomic_fetch_add_explicit(&fluxo->bytes, (uint64_t)enviados, memory_order_relaxed);
+    }
+}
+/*---------------------------------------------------------*/
+// Troca mensagens pequenas com o servidor medindo o tempo de ida e volta de cada uma
+static void enviaFluxoLatencia(FluxoBanda *fluxo){
+    char *resposta = malloc(fluxo->tamanhoMensagem);
+    int ligado = 1;
+
+    fluxo->latencias = malloc(BANDA_MAX_LATENCIAS * sizeof(double));
+    if (resposta == NULL || fluxo->latencias == NULL){
+        fluxo->erro = 1;
+        free(resposta);
+        return;
+    }
+    setsockopt(fluxo->socket, IPPROTO_TCP, TCP_NODELAY, &ligado, sizeof(ligado));
+
+    while (!atomic_load_explicit(fluxo->parar, memory_order_relaxed)){
+        double inicio = tempoAtual();
+        if (enviaTudo(fluxo->socket, fluxo->buffer, fluxo->tamanhoMensagem) != 0 ||
+            recebeTudo(fluxo->socket, resposta, fluxo->tamanhoMensagem) != 0){
+            fluxo->erro = 1;
+            break;
+        }
+        if (fluxo->numLatencias < BANDA_MAX_LATENCIAS){
+            fluxo->latencias[fluxo->numLatencias++] = tempoAtual() - inicio;
+        }
+        atomic_fetch_add_explicit(&fluxo->bytes, fluxo->tamanhoMensagem, memory_order_relaxed);
+        atomic_fetch_add_explicit(&fluxo->transacoes, 1, memory_order_relaxed);
+    }
+    free(resposta);
+}
+/*---------------------------------------------------------*/
+// Executa um fluxo do cliente e, ao final, recebe a confirmacao do servidor
+static void *executaFluxoBanda(void *argumento){
+    FluxoBanda *fluxo = argumento;
+    uint64_t confirmado;
+
+    fixaNoNucleo(fluxo->indice);
+
+    if (fluxo->modo == MODO_VAZAO){
+        enviaFluxoVazao(fluxo);
+    } else {
+        enviaFluxoLatencia(fluxo);
+    }
+
+    shutdown(fluxo->socket, SHUT_WR);
+    if (recebeTudo(fluxo->socket, &confirmado, sizeof(confirmado)) == 0){
+        fluxo->confirmado = be64toh(confirmado);
+    }
+    close(fluxo->socket);
+    return NULL;
+}
+/*---------------------------------------------------------*/
+// Compara duas latencias para a ordenacao dos percentis
+static int comparaLatencias(const void *a, const void *b){
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+#endif
+/*---------------------------------------------------------*/
+// Recebe uma sessao de teste de banda de um cliente e exibe o resultado
+int servidorDeBanda(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    int porta = obtemNumero(argc, argv, 0, "Digite a porta do servidor (ex.: 5201):", 1, 65535);
+    if (porta < 0){
+        printf("> Porta invalida!\n");
+        return -1;
+    }
+
+    int servidor = socket(AF_INET, SOCK_STREAM, 0);
+    int ligado = 1;
+    struct sockaddr_in endereco;
+
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sin_family = AF_INET;
+    endereco.sin_addr.s_addr = htonl(INADDR_ANY);
+    endereco.sin_port = htons((uint16_t)porta);
+
+    if (servidor < 0 || setsockopt(servidor, SOL_SOCKET, SO_REUSEADDR, &ligado, sizeof(ligado)) != 0 || bind(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 || listen(servidor, BANDA_MAX_FLUXOS) != 0){
+        printf("> Nao foi possivel escutar na porta %d!\n", porta);
+        if (servidor >= 0){
+            close(servidor);
+        }
+        return -1;
+    }
+
+    printf("> Aguardando um cliente na porta %d...\n", porta);
+    fflush(stdout);
+
+    ConexaoBanda conexoes[BANDA_MAX_FLUXOS];
+    int numConexoes = 0;
+    int numFluxos = 1;
+
+    // A primeira conexao informa quantos fluxos paralelos fazem parte da sessao
+    while (numConexoes < numFluxos){
+        struct pollfd evento = {servidor, POLLIN, 0};
+        if (numConexoes > 0 && poll(&evento, 1, 10000) <= 0){
+            printf("> Tempo esgotado aguardando os demais fluxos!\n");
+            break;
+        }
+
+        int cliente = accept(servidor, NULL, NULL);
+        if (cliente < 0){
+            break;
+        }
+
+        ConexaoBanda *conexao = &conexoes[numConexoes];
+        memset(conexao, 0, sizeof(*conexao));
+        conexao->socket = cliente;
+        conexao->indice = numConexoes;
+
+        // O cabecalho tem prazo: uma conexao que nao envia nada e descartada, sem travar o servidor
+        if (recebeTudoComPrazo(cliente, &conexao->cabecalho, sizeof(CabecalhoBanda), tempoAtual() + BANDA_PRAZO_CABECALHO) != 0 ||
+            ntohl(conexao->cabecalho.magico) != BANDA_MAGICO){
+            close(cliente);
+            continue;
+        }
+        conexao->cabecalho.modo = ntohl(conexao->cabecalho.modo);
+        conexao->cabecalho.numFluxos = ntohl(conexao->cabecalho.numFluxos);
+        conexao->cabecalho.tamanhoMensagem = ntohl(conexao->cabecalho.tamanhoMensagem);
+
+        if (conexao->cabecalho.numFluxos < 1 || conexao->cabecalho.numFluxos > BANDA_MAX_FLUXOS ||
+            conexao->cabecalho.tamanhoMensagem < 1 || conexao->cabecalho.tamanhoMensagem > BANDA_TAMANHO_BUFFER){
+            close(cliente);
+            continue;
+        }
+        if (numConexoes == 0){
+            numFluxos = (int)conexao->cabecalho.numFluxos;
+        }
+
+        if (pthread_create(&conexao->thread, NULL, atendeConexaoBanda, conexao) != 0){
+            close(cliente);
+            continue;
+        }
+        numConexoes++;
+    }
+    close(servidor);
+
+    uint64_t total = 0;
+    double duracao = 0;
+    for (int i = 0; i < numConexoes; i++){
+        pthread_join(conexoes[i].thread, NULL);
+        total += conexoes[i].bytes;
+        if (conexoes[i].duracao > duracao){
+            duracao = conexoes[i].duracao;
+        }
+    }
+
+    if (numConexoes > 0){
+        printf("> %d fluxos recebidos: %.1f MB em %.1f s (%.2f Gbit/s)\n", numConexoes, total / 1048576.0, duracao,
+               duracao > 0 ? total * 8 / duracao / 1e9 : 0.0);
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Mede a vazao TCP ou a latencia de requisicao/resposta ate um servidor de banda
+int clienteDeBanda(int argc, char *argv[]){
+    printaDivisao();
+
+#ifdef __linux__
+    char ip[MAX_ENDERECO];
+    struct sockaddr_in endereco;
+
+    if (obtemTexto(argc, argv, 0, "Digite o endereco IP do servidor (ex.: 127.0.0.1):", ip, sizeof(ip)) != 0){
+        printf("> Endereco invalido!\n");
+        return -1;
+    }
+
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sin_family = AF_INET;
+    if (inet_pton(AF_INET, ip, &endereco.sin_addr) != 1){
+        printf("> Endereco invalido!\n");
+        return -1;
+    }
+
+    int porta = obtemNumero(argc, argv, 1, "Digite a porta do servidor (ex.: 5201):", 1, 65535);
+    int duracao = porta < 0 ? -1 : obtemNumero(argc, argv, 2, "Digite a duracao do teste em segundos:", 1, 3600);
+    int modo = duracao < 0 ? -1 : obtemNumero(argc, argv, 3, "Escolha o modo: [1] Vazao  [2] Latencia", MODO_VAZAO, MODO_LATENCIA);
+    int metodo = METODO_COPIA;
+    int numFluxos = 1;
+    int tamanhoMensagem = BANDA_TAMANHO_BUFFER;
+
+    if (modo == MODO_VAZAO){
+        numFluxos = obtemNumero(argc, argv, 4, "Digite o numero de fluxos paralelos (1 a 64):", 1, BANDA_MAX_FLUXOS);
+        metodo = numFluxos < 0 ? -1 : obtemNumero(argc, argv, 5, "Escolha o metodo de envio: [1] Copia  [2] sendfile  [3] MSG_ZEROCOPY", METODO_COPIA, METODO_ZEROCOPY);
+    } else if (modo == MODO_LATENCIA){
+        tamanhoMensagem = obtemNumero(argc, argv, 4, "Digite o tamanho da mensagem em bytes (ex.: 64):", 1, BANDA_TAMANHO_BUFFER);
+    }
+
+    if (porta < 0 || modo < 0 || numFluxos < 0 || metodo < 0 || tamanhoMensagem < 0 || duracao < 0){
+        printf("> Opcao invalida!\n");
+        return -1;
+    }
+    endereco.sin_port = htons((uint16_t)porta);
+
+    // O mesmo buffer pre-alocado serve a todos os fluxos; o memfd e usado pelo sendfile()
+    char *buffer = malloc(BANDA_TAMANHO_BUFFER);
+    int memfd = -1;
+    if (buffer == NULL){
+        return -1;
+    }
+    for (int i = 0; i < BANDA_TAMANHO_BUFFER; i++){
+        buffer[i] = (char)('a' + i % 26);
+    }
+    if (metodo == METODO_SENDFILE){
+        memfd = memfd_create("comandos_banda", 0);
+        if (memfd < 0 || write(memfd, buffer, BANDA_TAMANHO_BUFFER) != BANDA_TAMANHO_BUFFER){
+            printf("> Nao foi possivel preparar o sendfile, usando copia.\n");
+            metodo = METODO_COPIA;
+        }
+    }
+
+    FluxoBanda *fluxos = calloc((size_t)numFluxos, sizeof(FluxoBanda));
+    _Atomic int parar = 0;
+    int iniciados = 0;
+
+    for (int i = 0; fluxos != NULL && i < numFluxos; i++){
+        FluxoBanda *fluxo = &fluxos[i];
+        CabecalhoBanda cabecalho = {htonl(BANDA_MAGICO), htonl((uint32_t)modo), htonl((uint32_t)i),
+                                    htonl((uint32_t)numFluxos), htonl((uint32_t)tamanhoMensagem)};
+
+        fluxo->socket = socket(AF_INET, SOCK_STREAM, 0);
+        if (fluxo->socket < 0 || connect(fluxo->socket, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 ||
+            enviaTudo(fluxo->socket, &cabecalho, sizeof(cabecalho)) != 0){
+            printf("> Nao foi possivel conectar em %s:%d!\n", ip, porta);
+            if (fluxo->socket >= 0){
+                close(fluxo->socket);
+            }
+            break;
+        }
+
+        fluxo->indice = i;
+        fluxo->modo = modo;
+        fluxo->metodo = metodo;
+        fluxo->tamanhoMensagem = (uint32_t)tamanhoMensagem;
+        fluxo->buffer = buffer;
+        fluxo->memfd = memfd;
+        fluxo->parar = &parar;
+        if (pthread_create(&fluxo->thread, NULL, executaFluxoBanda, fluxo) != 0){
+            close(fluxo->socket);
+            break;
+        }
+        iniciados++;
+    }
+
+    // Relatorio por intervalo de um segundo enquanto os fluxos rodam
+    uint64_t anterior = 0;
+    uint64_t transacoesAnteriores = 0;
+    double inicio = tempoAtual();
+    for (int segundo = 0; iniciados > 0 && segundo < duracao; segundo++){
+        struct timespec espera;
+        double alvo = inicio + segundo + 1;
+        double falta = alvo - tempoAtual();
+        if (falta > 0){
+            espera.tv_sec = (time_t)falta;
+            espera.tv_nsec = (long)((falta - (double)espera.tv_sec) * 1e9);
+            nanosleep(&espera, NULL);
+        }
+
+        uint64_t bytes = 0;
+        uint64_t transacoes = 0;
+        for (int i = 0; i < iniciados; i++){
+            bytes += atomic_load_explicit(&fluxos[i].bytes, memory_order_relaxed);
+            transacoes += atomic_load_explicit(&fluxos[i].transacoes, memory_order_relaxed);
+        }
+        if (modo == MODO_VAZAO){
+            printf("  [%3d-%3d s] %9.1f MB  %7.2f Gbit/s\n", segundo, segundo + 1, (bytes - anterior) / 1048576.0,
+                   (bytes - anterior) * 8 / 1e9);
+        } else {
+            printf("  [%3d-%3d s] %9llu transacoes/s\n", segundo, segundo + 1, (unsigned long long)(transacoes - transacoesAnteriores));
+        }
+        fflush(stdout);
+        anterior = bytes;
+        transacoesAnteriores = transacoes;
+    }
+    atomic_store(&parar, 1);
+
+    uint64_t total = 0;
+    uint64_t confirmado = 0;
+    size_t numLatencias = 0;
+    int erros = 0;
+    for (int i = 0; i < iniciados; i++){
+        pthread_join(fluxos[i].thread, NULL);
+        total += atomic_load(&fluxos[i].bytes);
+        confirmado += fluxos[i].confirmado;
+        numLatencias += fluxos[i].numLatencias;
+        erros += fluxos[i].erro;
+    }
+    double decorrido = tempoAtual() - inicio;
+
+    if (iniciados > 0 && modo == MODO_VAZAO){
+        printf("> Enviado: %.1f MB em %.1f s (%.2f Gbit/s), confirmado pelo servidor: %.1f MB\n", total / 1048576.0,
+               decorrido, total * 8 / decorrido / 1e9, confirmado / 1048576.0);
+    } else if (iniciados > 0 && numLatencias > 0){
+        double *todas = malloc(numLatencias * sizeof(double));
+        size_t k = 0;
+        double soma = 0;
+        for (int i = 0; todas != NULL && i < iniciados; i++){
+            for (size_t j = 0; j < fluxos[i].numLatencias; j++){
+                soma += fluxos[i].latencias[j];
+                todas[k++] = fluxos[i].latencias[j];
+            }
+        }
+        if (todas != NULL){
+            qsort(todas, numLatencias, sizeof(double), comparaLatencias);
+            printf("> %zu transacoes de %d bytes: media %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n", numLatencias,
+                   tamanhoMensagem, soma / numLatencias * 1e6, todas[numLatencias / 2] * 1e6,
+                   todas[(size_t)(numLatencias * 0.99)] * 1e6, todas[numLatencias - 1] * 1e6);
+        }
+        free(todas);
+    }
+    if (erros > 0){
+        printf("> %d fluxos foram interrompidos por erro na conexao.\n", erros);
+    }
+
+    for (int i = 0; i < iniciados; i++){
+        free(fluxos[i].latencias);
+    }
+    free(fluxos);
+    free(buffer);
+    if (memfd >= 0){
+        close(memfd);
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+/*---------------------------------------------------------*/
+// Limpa a tela do console
+int limparTela(int argc, char *argv[]){
+    telaLimpa();
+    return 0;
 }
 /*---------------------------------------------------------*/
-// Acessa uma pasta especifica da rede
-void acessarPasta(){
+// Altera a cor do console usando o comando color
+int trocarCor(int argc, char *argv[]){
     printaDivisao();
 
-    if (sistemaOperacional){
-        printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
-        return;
+    if (argc == 0){
+        const char *opcoes[] = {
+            "Azul",
+            "Verde",
+            "Azul Claro",
+            "Vermelho",
+            "Roxo",
+            "Amarelo",
+            "Branco",
+            "Cinza"
+        };
+        exibirMenu("Menu de Cores", opcoes, NULL, 8, "Voltar");
     }
 
-    char *diretorios[] = {
-        "\\\\fileserver\\suporte",
-        "\\\\fileserver\\temp",
-        "\\\\fileserver\\suporte\\softwares",
-        "\\\\fileserver\\suporte\\rotinas",
-    };
+    int opcao = obtemOpcao(argc, argv, 0, 8);
 
-    printf("> Menu de Pastas:\n");
-    printf("  [1] Suporte\n");
-    printf("  [2] Temp\n");
-    printf("  [3] Softwares\n");
-    printf("  [4] Rotinas\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
+    if (opcao == -1){
+        return -1;
+    }
 
-    int opcao = validaOpcao(4);
+    char comando[50];
+    sprintf(comando, "color %d", opcao);
 
-    if (opcao != -1){
-        char comando[100];
+    return executarComando(comando);
+}
+/*---------------------------------------------------------*/
+// Busca HTTP com cache para a previsao do tempo
+//
+// A ultima resposta valida fica em ~/.comandos_previsao.cache e e exibida na hora.
+// Se ela estiver velha, uma thread de fundo a revalida com If-None-Match e
+// If-Modified-Since enquanto o menu continua livre. Sem cache, a busca e feita na
+// hora. Toda busca tem um prazo total, que vale para a conexao, o envio e a leitura.
+//
+// O endereco padrao pode ser trocado pela variavel de ambiente COMANDOS_PREVISAO_URL
+// (somente http://).
+#define URL_PREVISAO_PADRAO "http://wttr.in/caxias?lang=pt-br&Q&F"
+#define PRAZO_PREVISAO 5.0
+#define VALIDADE_PREVISAO (10 * 60)
+#define TAMANHO_MAXIMO_PREVISAO (256 * 1024)
 
-        sprintf(comando, "start %s", diretorios[opcao - 1]);
+typedef struct {
+    char url[256];
+    char etag[128];
+    char modificado[64];
+    long buscado;
+    char *corpo;
+    size_t tamanho;
+} RespostaEmCache;
 
-        system(comando);
-        printaMensagem(comando);
+#ifdef __linux__
+static _Atomic int atualizandoPrevisao = 0;
+static pthread_t threadPrevisao;
+static int threadPrevisaoCriada = 0;
+static int esperaPrevisaoRegistrada = 0;
+/*---------------------------------------------------------*/
+// Obtem o endereco configurado para a previsao do tempo
+static const char *urlDaPrevisao(){
+    const char *url = getenv("COMANDOS_PREVISAO_URL");
+    return url != NULL && url[0] != '\0' ? url : URL_PREVISAO_PADRAO;
+}
+/*---------------------------------------------------------*/
+// Monta o caminho do arquivo de cache no HOME do usuario
+static int caminhoDoCachePrevisao(char *caminho, size_t tamanho){
+    const char *home = getenv("HOME");
+    if (home == NULL){
+        return -1;
     }
+    snprintf(caminho, tamanho, "%s/.comandos_previsao.cache", home);
+    return 0;
 }
 /*---------------------------------------------------------*/
-// Controla o menu das ferramentas de rede 
-void menuDeRede(){
-    printaDivisao();
+// Le o cache: linhas "chave valor" com url, etag, modificado e buscado, uma linha vazia e o corpo
+static int leCachePrevisao(RespostaEmCache *cache){
+    char caminho[512];
+    char linha[512];
 
-    printf("> Menu de Ferramentas de Rede:\n");
-    printf("  [1] Ver IP do Computador\n");
-    printf("  [2] Pingar em um IP\n");
-    printf("  [3] Descobrir a Rota de um IP\n");
-    printf("  [4] Ver Mapeamentos de Rede\n");
-    printf("  [5] Exibir Estatisticas de Rede\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
+    memset(cache, 0, sizeof(*cache));
+    if (caminhoDoCachePrevisao(caminho, sizeof(caminho)) != 0){
+        return -1;
+    }
 
-    int opcao = validaOpcao(5);
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL){
+        return -1;
+    }
 
-    switch(opcao){
-        case 1:
-            verIPDaMaquina();
-            break;
-        case 2:
-            pingarEmUmPC();
-            break;
-        case 3:
-            descobrirRotaDoIP();
-            break;
-        case 4:
-            verMapeamentoDeRede();
-            break;
-        case 5:
-            verEstatisticasDeRede();
-            break;
+    while (fgets(linha, sizeof(linha), arquivo) != NULL && linha[0] != '\n'){
+        linha[strcspn(linha, "\n")] = '\0';
+        char *valor = strchr(linha, ' ');
+        valor = valor != NULL ? valor + 1 : "";
+
+        if (strncmp(linha, "url ", 4) == 0){
+            snprintf(cache->url, sizeof(cache->url), "%s", valor);
+        } else if (strncmp(linha, "etag ", 5) == 0){
+            snprintf(cache->etag, sizeof(cache->etag), "%s", valor);
+        } else if (strncmp(linha, "modificado ", 11) == 0){
+            snprintf(cache->modificado, sizeof(cache->modificado), "%s", valor);
+        } else if (strncmp(linha, "buscado ", 8) == 0){
+            cache->buscado = atol(valor);
+        }
     }
-}
-/*---------------------------------------------------------*/
-// Exibe o IP da maquina usando o comando ipconfig
-void verIPDaMaquina(){
-    printaDivisao();
-    char comando[50];
 
-    if(sistemaOperacional){
-        strcpy(comando, "ip addr");
-    } else {
-        strcpy(comando, "ipconfig /all");
+    cache->corpo = malloc(TAMANHO_MAXIMO_PREVISAO);
+    if (cache->corpo != NULL){
+        cache->tamanho = fread(cache->corpo, 1, TAMANHO_MAXIMO_PREVISAO, arquivo);
     }
+    fclose(arquivo);
 
-    system(comando);
-    printaMensagem(comando);
+    // Um cache de outro endereco nao serve
+    if (cache->corpo == NULL || strcmp(cache->url, urlDaPrevisao()) != 0){
+        free(cache->corpo);
+        cache->corpo = NULL;
+        return -1;
+    }
+    return 0;
 }
 /*---------------------------------------------------------*/
-// Pinga um PC especifico usando o comando ping
-void pingarEmUmPC(){
-    printaDivisao();
-    char ip[MAX_IP_LENGTH]; 
-   
-    printf("> Digite o endereco IP que deseja pingar:\n");
-    printf("> ");
-    scanf("%15s", ip); 
-    fflush(stdin);
+// Grava o cache em um arquivo temporario e o renomeia, para nunca deixar um cache pela metade
+static int gravaCachePrevisao(const RespostaEmCache *cache){
+    char caminho[512];
+    char temporario[530];
 
-    char comando[100];
+    if (caminhoDoCachePrevisao(caminho, sizeof(caminho)) != 0){
+        return -1;
+    }
+    snprintf(temporario, sizeof(temporario), "%s.%d", caminho, (int)getpid());
 
-    if(sistemaOperacional){
-        sprintf(comando, "timeout 6s ping %s", ip);
-    } else {
-        sprintf(comando, "ping %s", ip);
+    FILE *arquivo = fopen(temporario, "wb");
+    if (arquivo == NULL){
+        return -1;
     }
+    fprintf(arquivo, "url %s\netag %s\nmodificado %s\nbuscado %ld\n\n", cache->url, cache->etag, cache->modificado, cache->buscado);
+    fwrite(cache->corpo, 1, cache->tamanho, arquivo);
 
-    system(comando);
-    printaMensagem(comando);
+    if (fclose(arquivo) != 0 || rename(temporario, caminho) != 0){
+        remove(temporario);
+        return -1;
+    }
+    return 0;
 }
 /*---------------------------------------------------------*/
-// Rastreia a rota de um IP especifico usando o comando tracert
-void descobrirRotaDoIP(){
-    printaDivisao();
-    char ip[MAX_IP_LENGTH]; 
-   
-    printf("> Digite o endereco IP que deseja rastrear:\n");
-    printf("> ");
-    scanf("%15s", ip); 
-    fflush(stdin);
+// Separa uma URL http://servidor[:porta]/caminho
+static int separaUrl(const char *url, char *servidor, size_t tamanhoServidor, char *porta, size_t tamanhoPorta,
+                     char *caminho, size_t tamanhoCaminho){
+    if (strncmp(url, "http://", 7) != 0){
+        return -1;
+    }
+    url += 7;
 
-    char comando[100];
+    size_t fimServidor = strcspn(url, ":/?");
+    if (fimServidor == 0 || fimServidor >= tamanhoServidor){
+        return -1;
+    }
+    memcpy(servidor, url, fimServidor);
+    servidor[fimServidor] = '\0';
+    url += fimServidor;
 
-    if(sistemaOperacional){
-        sprintf(comando, "traceroute %s", ip);
-    } else {
-        sprintf(comando, "tracert %s", ip);
+    snprintf(porta, tamanhoPorta, "80");
+    if (*url == ':'){
+        size_t fimPorta = strcspn(++url, "/?");
+        if (fimPorta == 0 || fimPorta >= tamanhoPorta){
+            return -1;
+        }
+        memcpy(porta, url, fimPorta);
+        porta[fimPorta] = '\0';
+        url += fimPorta;
     }
 
-    system(comando);
-    printaMensagem(comando);
+    snprintf(caminho, tamanhoCaminho, "%s%s", *url == '/' ? "" : "/", url);
+    return 0;
 }
 /*---------------------------------------------------------*/
-// Exibe os mapeamentos de rede utilizando o comando net use
-void verMapeamentoDeRede(){
-    printaDivisao();
-    char comando[50];
-
-    if (sistemaOperacional){
-        strcpy(comando, "df -h");
-    } else {
-        strcpy(comando, "net use");
+// Resolucao de nome feita em uma thread propria. Quem esperou ate o prazo marca a
+// resolucao como abandonada, e a thread libera tudo quando o getaddrinfo voltar.
+typedef struct {
+    pthread_mutex_t trava;
+    pthread_cond_t pronta;
+    int terminou;
+    int abandonada;
+    int erro;
+    char servidor[128];
+    char porta[8];
+    struct addrinfo *enderecos;
+} ResolucaoDeNome;
+/*---------------------------------------------------------*/
+// Libera a resolucao e os enderecos que ninguem recolheu
+static void liberaResolucao(ResolucaoDeNome *resolucao){
+    if (resolucao->enderecos != NULL){
+        freeaddrinfo(resolucao->enderecos);
     }
-
-    system(comando);
-    printaMensagem(comando);
+    pthread_cond_destroy(&resolucao->pronta);
+    pthread_mutex_destroy(&resolucao->trava);
+    free(resolucao);
 }
 /*---------------------------------------------------------*/
-// Exibe as estatisticas de rede utilizando o comando netstat
-void verEstatisticasDeRede(){
-    printaDivisao();
-    char comando[50];
+// Thread que chama o getaddrinfo, que nao tem prazo proprio
+static void *resolveNome(void *argumento){
+    ResolucaoDeNome *resolucao = argumento;
+    struct addrinfo dicas = {0};
+    struct addrinfo *enderecos = NULL;
 
-    if (sistemaOperacional){
-        strcpy(comando, "ss -tuln");
-    } else {
-        strcpy(comando, "netstat -s -p IP");
-    }
+    dicas.ai_family = AF_UNSPEC;
+    dicas.ai_socktype = SOCK_STREAM;
+    int erro = getaddrinfo(resolucao->servidor, resolucao->porta, &dicas, &enderecos);
 
-    system(comando);
-    printaMensagem(comando);
+    pthread_mutex_lock(&resolucao->trava);
+    resolucao->erro = erro;
+    resolucao->enderecos = erro == 0 ? enderecos : NULL;
+    resolucao->terminou = 1;
+    int abandonada = resolucao->abandonada;
+    pthread_cond_signal(&resolucao->pronta);
+    pthread_mutex_unlock(&resolucao->trava);
+
+    if (abandonada){
+        liberaResolucao(resolucao);
+    }
+    return NULL;
 }
 /*---------------------------------------------------------*/
-// Controla o menu de politicas de grupo
-void menuPoliticaDeGrupo(){
+// Resolve o servidor sem esperar alem do prazo; retorna NULL em caso de erro ou prazo esgotado
+static struct addrinfo *resolveComPrazo(const char *servidor, const char *porta, double prazo){
+    ResolucaoDeNome *resolucao = calloc(1, sizeof(*resolucao));
+    pthread_condattr_t atributosCondicao;
+    pthread_attr_t atributos;
+    pthread_t thread;
 
-    if (sistemaOperacional){
-        printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
-        return;
+    if (resolucao == NULL){
+        return NULL;
     }
+    snprintf(resolucao->servidor, sizeof(resolucao->servidor), "%s", servidor);
+    snprintf(resolucao->porta, sizeof(resolucao->porta), "%s", porta);
+    pthread_mutex_init(&resolucao->trava, NULL);
 
-    printaDivisao();
+    // O prazo vem do tempoAtual(), entao a espera usa o mesmo relogio monotonico
+    pthread_condattr_init(&atributosCondicao);
+    pthread_condattr_setclock(&atributosCondicao, CLOCK_MONOTONIC);
+    pthread_cond_init(&resolucao->pronta, &atributosCondicao);
+    pthread_condattr_destroy(&atributosCondicao);
 
-    printf("> Menu de Politicas de Grupo:\n");
-    printf("  [1] Atualizar Politica de Grupo\n");
-    printf("  [2] Ver Resultado da Politica de Grupo\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
+    pthread_attr_init(&atributos);
+    pthread_attr_setdetachstate(&atributos, PTHREAD_CREATE_DETACHED);
+    int criada = pthread_create(&thread, &atributos, resolveNome, resolucao) == 0;
+    pthread_attr_destroy(&atributos);
+    if (!criada){
+        liberaResolucao(resolucao);
+        return NULL;
+    }
 
-    int opcao = validaOpcao(2);
+    struct timespec limite;
+    limite.tv_sec = (time_t)prazo;
+    limite.tv_nsec = (long)((prazo - (double)limite.tv_sec) * 1e9);
 
-    switch(opcao){
-        case 1:
-            atualizarPolitica();
-            break;
-        case 2:
-            verResultadoDaPolitica();
+    pthread_mutex_lock(&resolucao->trava);
+    while (!resolucao->terminou){
+        if (pthread_cond_timedwait(&resolucao->pronta, &resolucao->trava, &limite) == ETIMEDOUT){
             break;
+        }
+    }
+    if (!resolucao->terminou){
+        resolucao->abandonada = 1;
+        pthread_mutex_unlock(&resolucao->trava);
+        return NULL;
     }
+    pthread_mutex_unlock(&resolucao->trava);
+
+    struct addrinfo *enderecos = resolucao->enderecos;
+    resolucao->enderecos = NULL;
+    liberaResolucao(resolucao);
+    return enderecos;
 }
 /*---------------------------------------------------------*/
-// Atualiza a politica de grupo utilizando o comando gpupdate
-void atualizarPolitica(){
-    printaDivisao();
-    char comando[50];
+// Conecta ao servidor sem bloquear alem do prazo, tentando cada endereco resolvido
+static int conectaComPrazo(const char *servidor, const char *porta, double prazo){
+    struct addrinfo *enderecos = resolveComPrazo(servidor, porta, prazo);
+    int conexao = -1;
 
-    strcpy(comando, "gpupdate /force /boot");
+    if (enderecos == NULL){
+        return -1;
+    }
 
-    system(comando);
-    printaMensagem(comando);
+    for (struct addrinfo *endereco = enderecos; endereco != NULL && conexao < 0; endereco = endereco->ai_next){
+        int fd = socket(endereco->ai_family, endereco->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, endereco->ai_protocol);
+        if (fd < 0){
+            continue;
+        }
+
+        if (connect(fd, endereco->ai_addr, endereco->ai_addrlen) == 0){
+            conexao = fd;
+            break;
+        }
+        if (errno == EINPROGRESS){
+            struct pollfd espera = {fd, POLLOUT, 0};
+            int restante = (int)((prazo - tempoAtual()) * 1000);
+            int erro = 0;
+            socklen_t tamanho = sizeof(erro);
+
+            if (restante > 0 && poll(&espera, 1, restante) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &erro, &tamanho) == 0 && erro == 0){
+                conexao = fd;
+                break;
+            }
+        }
+        close(fd);
+    }
+
+    freeaddrinfo(enderecos);
+    return conexao;
 }
 /*---------------------------------------------------------*/
-// Exibe o resultado da politica de grupo utilizando o comando gpresult
-void verResultadoDaPolitica(){
-    printaDivisao();
-    char comando[50];
-
-    strcpy(comando, "gpresult /r");
+// Copia o valor de um cabecalho HTTP (sem diferenciar maiusculas) para o destino
+static void copiaCabecalho(const char *cabecalhos, const char *nome, char *destino, size_t tamanho){
+    size_t tamanhoNome = strlen(nome);
 
-    system(comando);
-    printaMensagem(comando);
+    for (const char *linha = cabecalhos; linha != NULL && *linha != '\0'; linha = strstr(linha, "\r\n")){
+        if (linha[0] == '\r'){
+            linha += 2;
+        }
+        if (strncasecmp(linha, nome, tamanhoNome) == 0 && linha[tamanhoNome] == ':'){
+            const char *valor = linha + tamanhoNome + 1;
+            while (*valor == ' '){
+                valor++;
+            }
+            size_t fim = strcspn(valor, "\r\n");
+            snprintf(destino, tamanho, "%.*s", (int)(fim < tamanho ? fim : tamanho - 1), valor);
+            return;
+        }
+    }
 }
 /*---------------------------------------------------------*/
-// Controla o menu de informacoes sobre o sistema
-void menuInformacoes(){
+// Busca a previsao com uma requisicao condicional; retorna o codigo HTTP ou -1 em caso de erro ou prazo esgotado
+static int buscaPrevisao(RespostaEmCache *cache, const RespostaEmCache *anterior){
+    char servidor[128], porta[8], caminho[256];
+    char requisicao[1024];
+    double prazo = tempoAtual() + PRAZO_PREVISAO;
 
-    printaDivisao();
+    memset(cache, 0, sizeof(*cache));
+    snprintf(cache->url, sizeof(cache->url), "%s", urlDaPrevisao());
+    if (separaUrl(cache->url, servidor, sizeof(servidor), porta, sizeof(porta), caminho, sizeof(caminho)) != 0){
+        return -1;
+    }
 
-    printf("> Menu de Informacoes do Sistema:\n");
-    printf("  [1] Informacoes do Hardware\n");
-    printf("  [2] Listar Drivers Instalados\n");
-    printf("  [3] Listar Processos em Execucao\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
+    // HTTP/1.0 com Connection: close evita a codificacao em blocos; o fim da resposta e o fechamento da conexao
+    int usados = snprintf(requisicao, sizeof(requisicao),
+                          "GET %s HTTP/1.0\r\nHost: %s\r\nUser-Agent: curl/8 (comandos)\r\nAccept: */*\r\nConnection: close\r\n",
+                          caminho, servidor);
+    if (anterior != NULL && anterior->etag[0] != '\0'){
+        usados += snprintf(requisicao + usados, sizeof(requisicao) - (size_t)usados, "If-None-Match: %s\r\n", anterior->etag);
+    }
+    if (anterior != NULL && anterior->modificado[0] != '\0'){
+        usados += snprintf(requisicao + usados, sizeof(requisicao) - (size_t)usados, "If-Modified-Since: %s\r\n", anterior->modificado);
+    }
+    usados += snprintf(requisicao + usados, sizeof(requisicao) - (size_t)usados, "\r\n");
+    if ((size_t)usados >= sizeof(requisicao)){
+        return -1;
+    }
 
-    int opcao = validaOpcao(2);
+    int conexao = conectaComPrazo(servidor, porta, prazo);
+    if (conexao < 0){
+        return -1;
+    }
+
+    char *resposta = malloc(TAMANHO_MAXIMO_PREVISAO + 1);
+    size_t recebidos = 0;
+    size_t enviados = 0;
+    int completa = 0;
+
+    while (resposta != NULL && !completa){
+        int restante = (int)((prazo - tempoAtual()) * 1000);
+        struct pollfd espera = {conexao, enviados < (size_t)usados ? POLLOUT : POLLIN, 0};
 
-    switch(opcao){
-        case 1:
-            verInformacoesDoSistema();
+        if (restante <= 0 || poll(&espera, 1, restante) <= 0){
             break;
-        case 2:
-            listarDrivers();
+        }
+
+        if (enviados < (size_t)usados){
+            ssize_t escrito = send(conexao, requisicao + enviados, (size_t)usados - enviados, MSG_NOSIGNAL);
+            if (escrito < 0 && errno != EAGAIN){
+                break;
+            }
+            enviados += escrito > 0 ? (size_t)escrito : 0;
+            continue;
+        }
+
+        ssize_t lido = recv(conexao, resposta + recebidos, TAMANHO_MAXIMO_PREVISAO - recebidos, 0);
+        if (lido == 0){
+            completa = 1;
+        } else if (lido < 0 && errno != EAGAIN){
             break;
-        case 3:
-            verListaDeProcessos();
+        } else if (lido > 0 && (recebidos += (size_t)lido) == TAMANHO_MAXIMO_PREVISAO){
             break;
+        }
     }
-}
-/*---------------------------------------------------------*/
-// Exibe informacoes do sistema usando o comando systeminfo
-void verInformacoesDoSistema(){
-    printaDivisao();
-    char comando[50];
+    close(conexao);
 
-    if (sistemaOperacional){
-        strcpy(comando, "lshw");
-    } else {
-        strcpy(comando, "systeminfo");
-    }
+    int codigo = -1;
+    char *fimCabecalhos;
 
-    system(comando);
-    printaMensagem(comando);
-}
-/*---------------------------------------------------------*/
-// Lista os drivers instalados usando o comando driverquery
-void listarDrivers(){
-    printaDivisao();
-    char comando[50];
+    if (resposta != NULL && completa){
+        resposta[recebidos] = '\0';
+        fimCabecalhos = strstr(resposta, "\r\n\r\n");
+        if (fimCabecalhos != NULL && sscanf(resposta, "HTTP/%*d.%*d %d", &codigo) == 1){
+            *fimCabecalhos = '\0';
+            copiaCabecalho(resposta, "ETag", cache->etag, sizeof(cache->etag));
+            copiaCabecalho(resposta, "Last-Modified", cache->modificado, sizeof(cache->modificado));
 
-    if (sistemaOperacional){
-        strcpy(comando, "lsmod");
-    } else {
-        strcpy(comando, "driverquery");
+            cache->tamanho = recebidos - (size_t)(fimCabecalhos + 4 - resposta);
+            memmove(resposta, fimCabecalhos + 4, cache->tamanho);
+            cache->corpo = resposta;
+            cache->buscado = (long)time(NULL);
+            return codigo;
+        }
     }
 
-    system(comando);
-    printaMensagem(comando);
+    free(resposta);
+    return -1;
 }
 /*---------------------------------------------------------*/
-// Lista os processos em execucao usando o comando tasklist
-void verListaDeProcessos(){
-    printaDivisao();
-    char comando[50];
+// Busca e grava o cache; um 304 apenas renova a data da resposta guardada
+static int atualizaCachePrevisao(RespostaEmCache *anterior, RespostaEmCache *nova){
+    int codigo = buscaPrevisao(nova, anterior);
 
-    if (sistemaOperacional){
-        strcpy(comando, "ps aux");
-    } else {
-        strcpy(comando, "tasklist");
+    if (codigo == 304 && anterior != NULL && anterior->corpo != NULL){
+        anterior->buscado = (long)time(NULL);
+        gravaCachePrevisao(anterior);
+    } else if (codigo == 200){
+        gravaCachePrevisao(nova);
     }
-
-    system(comando);
-    printaMensagem(comando);
+    return codigo;
 }
 /*---------------------------------------------------------*/
-// Controla o menu de funcionalidades extras
-void menuFuncionalidadesExtras(){
-    printaDivisao();
+// Thread de fundo que revalida o cache sem travar o menu
+static void *revalidaPrevisao(void *argumento){
+    RespostaEmCache *anterior = argumento;
+    RespostaEmCache nova;
 
-    printf("> Menu de Funcionalidades Extras:\n");
-    printf("  [1] Limpar Tela\n");
-    printf("  [2] Trocar Cor\n");
-    printf("  [3] Ver Previsao do Tempo\n");
-    printf("  [4] Abrir a Calculadora\n");
-    printf("  [5] Abrir o Bloco de Notas\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
-
-    int opcao = validaOpcao(4);
+    atualizaCachePrevisao(anterior, &nova);
 
-    switch(opcao){
-        case 1:
-            limparTela();
-            break;
-        case 2:
-            trocarCor();
-            break;
-        case 3:
-            verPrevisaoDoTempo();
-            break;
-        case 4:
-            abrirCalculadora();
-            break;
-        case 5:
-            abrirBlocoDeNotas();
-            break;
-    }
+    free(nova.corpo);
+    free(anterior->corpo);
+    free(anterior);
+    atomic_store(&atualizandoPrevisao, 0);
+    return NULL;
 }
 /*---------------------------------------------------------*/
-// Limpa a tela do console usando o comando cls
-void limparTela(){
-    printaDivisao();
-    char comando[50];
-
-    if (sistemaOperacional){
-        strcpy(comando, "clear");
-    } else {
-        strcpy(comando, "cls");
+// Espera a revalidacao em andamento na saida do programa, no maximo ate o prazo da busca
+static void aguardaRevalidacaoPrevisao(){
+    if (threadPrevisaoCriada){
+        pthread_join(threadPrevisao, NULL);
+        threadPrevisaoCriada = 0;
     }
-
-    system(comando);
-    printaMensagem(comando);
 }
+#endif
 /*---------------------------------------------------------*/
-// Altera a cor do console usando o comando color
-void trocarCor(){
+// Exibe a previsao do tempo consultando uma API, com cache e atualizacao em segundo plano
+int verPrevisaoDoTempo(int argc, char *argv[]){
     printaDivisao();
 
-    if (sistemaOperacional){
-        printf("Desculpe, este comando nao e suportado neste sistema operacional.\n");
-        return;
+#ifdef __linux__
+    RespostaEmCache *cache = malloc(sizeof(RespostaEmCache));
+    RespostaEmCache nova;
+
+    if (cache == NULL){
+        return -1;
     }
 
-    printf("> Menu de Cores:\n");
-    printf("  [1] Azul\n");
-    printf("  [2] Verde\n");
-    printf("  [3] Azul Claro\n");
-    printf("  [4] Vermelho\n");
-    printf("  [5] Roxo\n");
-    printf("  [6] Amarelo\n");
-    printf("  [7] Branco\n");
-    printf("  [8] Cinza\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
+    if (leCachePrevisao(cache) == 0){
+        long idade = (long)time(NULL) - cache->buscado;
 
-    int opcao = validaOpcao(8);
+        fwrite(cache->corpo, 1, cache->tamanho, stdout);
+        printf("> Dados de %ld minuto(s) atras.\n", idade / 60);
 
-    if (opcao != -1){
-        char comando[50];
-        sprintf(comando, "color %d", opcao);
+        // Resposta velha: mostra a que existe e revalida em segundo plano, uma busca por vez
+        if (idade >= VALIDADE_PREVISAO && !atomic_exchange(&atualizandoPrevisao, 1)){
+            aguardaRevalidacaoPrevisao();
+            if (pthread_create(&threadPrevisao, NULL, revalidaPrevisao, cache) == 0){
+                if (!esperaPrevisaoRegistrada){
+                    atexit(aguardaRevalidacaoPrevisao);
+                    esperaPrevisaoRegistrada = 1;
+                }
+                threadPrevisaoCriada = 1;
+                printf("> Atualizando em segundo plano; a proxima consulta mostrara os dados novos.\n");
+                return 0;
+            }
+            atomic_store(&atualizandoPrevisao, 0);
+        }
+        free(cache->corpo);
+        free(cache);
+        return 0;
+    }
+    free(cache);
 
-        system(comando);
-        printaMensagem(comando);
+    int codigo = atualizaCachePrevisao(NULL, &nova);
+    if (codigo == 200){
+        fwrite(nova.corpo, 1, nova.tamanho, stdout);
+        free(nova.corpo);
+        return 0;
     }
-}
-/*---------------------------------------------------------*/
-// Exibe a previsao do tempo consultando uma API
-void verPrevisaoDoTempo(){
-    printaDivisao();
+    free(nova.corpo);
+
+    if (codigo == -1){
+        printf("> Nao foi possivel obter a previsao do tempo em %.0f segundos (%s).\n", PRAZO_PREVISAO, urlDaPrevisao());
+    } else {
+        printf("> O servidor da previsao do tempo respondeu com o codigo %d.\n", codigo);
+    }
+    return -1;
+#else
     char comando[50];
 
     strcpy(comando, "curl wttr.in/caxias?lang=pt-br^&Q^&F");
 
-    system(comando);
-    printaMensagem(comando);
+    return executarComando(comando);
+#endif
 }
 /*---------------------------------------------------------*/
 // Abre a calculadora
-void abrirCalculadora(){
+int abrirCalculadora(int argc, char *argv[]){
     char comando[50];
 
     if (sistemaOperacional){
@@ -648,12 +5953,11 @@ void abrirCalculadora(){
         strcpy(comando, "calc");
     }
 
-    system(comando);
-    printaMensagem(comando);
+    return executarComando(comando);
 }
 /*---------------------------------------------------------*/
 // Abre o bloco de notas
-void abrirBlocoDeNotas(){
+int abrirBlocoDeNotas(int argc, char *argv[]){
     char comando[50];
 
     if (sistemaOperacional){
@@ -662,46 +5966,21 @@ void abrirBlocoDeNotas(){
         strcpy(comando, "notepad");
     }
 
-    system(comando);
-    printaMensagem(comando);
-}
-/*---------------------------------------------------------*/
-// Controla o menu de jogos
-void menuJogos(){
-
-    printaDivisao();
-
-    printf("> Menu de Jogos:\n");
-    printf("  [1] Quiz\n");
-    printf("  [2] Snake\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
-
-    int opcao = validaOpcao(2);
-
-    switch(opcao){
-        case 1:
-            gerarQuestionario();
-            break;
-        case 2:
-            jogarJogoCobra();
-            break;
-    }
+    return executarComando(comando);
 }
 /*---------------------------------------------------------*/
 // Gera um questionario sobre principais comandos de sistema
-void gerarQuestionario(){
+int gerarQuestionario(int argc, char *argv[]){
     printaDivisao();
     char comando[50];
+    int retorno = -1;
 
     if (sistemaOperacional){
         if (system("python3 --version") == 0) {
             strcpy(comando, "python3 quiz.py");
-            system("clear");
-            system(comando);
-            system("clear");
+            telaLimpa();
+            retorno = codigoDeSaida(system(comando));
+            telaLimpa();
             printaMensagem(comando);
         } else {
             printf("Python nao esta instalado.\n");
@@ -709,27 +5988,29 @@ void gerarQuestionario(){
     } else {
         if (system("python --version") == 0) {
             strcpy(comando, "python quiz.py");
-            system("cls");
-            system(comando);
-            system("cls");
+            telaLimpa();
+            retorno = codigoDeSaida(system(comando));
+            telaLimpa();
             printaMensagem(comando);
         } else {
             printf("Python nao esta instalado.\n");
         }
     }
+    return retorno;
 }
 /*---------------------------------------------------------*/
 // Inicia o jogo da cobrinha
-void jogarJogoCobra(){
+int jogarJogoCobra(int argc, char *argv[]){
     printaDivisao();
     char comando[50];
+    int retorno = -1;
 
     if (sistemaOperacional){
         if (system("pip3 show pygame > /dev/null 2>&1") == 0) {
             strcpy(comando, "python3 snake.py");
-            system("clear");
-            system(comando);
-            system("clear");
+            telaLimpa();
+            retorno = codigoDeSaida(system(comando));
+            telaLimpa();
             printaMensagem(comando);
         } else {
             printf("Pygame nao esta instalado.\n");
@@ -737,54 +6018,19 @@ void jogarJogoCobra(){
     } else {
         if (system("pip show pygame > NUL 2>&1") == 0) {
             strcpy(comando, "python snake.py");
-            system("cls");
-            system(comando);
-            system("cls");
+            telaLimpa();
+            retorno = codigoDeSaida(system(comando));
+            telaLimpa();
             printaMensagem(comando);
         } else {
             printf("Pygame nao esta instalado.\n");
         }
     }
-}
-/*---------------------------------------------------------*/
-// Controla o menu de desligar/reiniciar o computador
-void menuDesligarOuReiniciar(){
-    printaDivisao();
-
-    printf("> Menu Reiniciar/Desligar:\n");
-    printf("  [1] Reiniciar\n");
-    printf("  [2] Desligar\n");
-    printf("  [3] Agendar Reinicializacao\n");
-    printf("  [4] Agendar Desligamento\n");
-    printf("  [5] Cancelar Agendamento\n");
-    printf("  [0] Voltar\n");
-    printf("\n");
-    printf("> Escolha uma opcao:\n");
-    printf("> ");
-
-    int opcao = validaOpcao(5);
-
-    switch(opcao){
-        case 1:
-            reiniciarComputador();
-            break;
-        case 2:
-            desligarComputador();
-            break;
-        case 3:
-            agendarReinicializacao();
-            break;
-        case 4:
-            agendarDesligamento();
-            break;
-        case 5:
-            cancelarAgendamento();
-            break;
-    }
+    return retorno;
 }
 /*---------------------------------------------------------*/
 // Reinicia o computador usando o comando shutdown
-void reiniciarComputador(){
+int reiniciarComputador(int argc, char *argv[]){
     printaDivisao();
     char comando[50];
 
@@ -800,15 +6046,15 @@ void reiniciarComputador(){
             } else {
                 strcpy(comando, "shutdown /r /t 0");
             }
-            system(comando);
-            printaMensagem(comando);
+            executarComando(comando);
             exit(0);
         }
     }
+    return -1;
 }
 /*---------------------------------------------------------*/
 // Desliga o computador usando o comando shutdown
-void desligarComputador(){
+int desligarComputador(int argc, char *argv[]){
     printaDivisao();
     char comando[50];
 
@@ -824,25 +6070,21 @@ void desligarComputador(){
             } else {
                 strcpy(comando, "shutdown /s /t 0");
             }
-            system(comando);
-            printaMensagem(comando);
+            executarComando(comando);
             exit(0);
         }
     }
+    return -1;
 }
 /*---------------------------------------------------------*/
 // Funcao para agendar o reiniciamento do computador apos um tempo especificado
-void agendarReinicializacao(){
+int agendarReinicializacao(int argc, char *argv[]){
     printaDivisao();
     float minutos;
 
-    printf("> Informe o tempo em minutos para a reinicializacao:\n");
-    printf("> ");
-    
-    if (scanf("%f", &minutos) != 1 || minutos <= 0) {
+    if (obtemMinutos(argc, argv, 0, "Informe o tempo em minutos para a reinicializacao:", &minutos) != 0) {
         printf("> Tempo invalido!\n");
-        while (getchar() != '\n');
-        return;
+        return -1;
     }
 
     int segundos = (int)(minutos * 60); 
@@ -855,24 +6097,20 @@ void agendarReinicializacao(){
         sprintf(comando, "shutdown /r /t %d", segundos);
     }
 
-    system(comando);
-    printaMensagem(comando);
+    int retorno = executarComando(comando);
 
     printf("> O computador sera reiniciado em %.1f minutos (%d segundos)!\n", minutos, segundos);
+    return retorno;
 }
 /*---------------------------------------------------------*/
 // Funcao para agendar o desligamento do computador apos um tempo especificado
-void agendarDesligamento(){
+int agendarDesligamento(int argc, char *argv[]){
     printaDivisao();
     float minutos;
 
-    printf("> Informe o tempo em minutos para o desligamento:\n");
-    printf("> ");
-    
-    if (scanf("%f", &minutos) != 1 || minutos <= 0) {
+    if (obtemMinutos(argc, argv, 0, "Informe o tempo em minutos para o desligamento:", &minutos) != 0) {
         printf("> Tempo invalido!\n");
-        while (getchar() != '\n');
-        return;
+        return -1;
     }
 
     int segundos = (int)(minutos * 60); 
@@ -885,14 +6123,14 @@ void agendarDesligamento(){
         sprintf(comando, "shutdown /s /t %d", segundos);
     }
 
-    system(comando);
-    printaMensagem(comando);
+    int retorno = executarComando(comando);
 
     printf("> O computador sera desligado em %.1f minutos (%d segundos)!\n", minutos, segundos);
+    return retorno;
 }
 /*---------------------------------------------------------*/
 // Funcao para cancelar o agendamento de reinicializacao/desligamento
-void cancelarAgendamento(){
+int cancelarAgendamento(int argc, char *argv[]){
     int retorno;
     char comando[50];
 
@@ -902,11 +6140,11 @@ void cancelarAgendamento(){
         strcpy(comando, "shutdown /a");
     }
 
-    retorno = system(comando);
-    printaMensagem(comando);
+    retorno = executarComando(comando);
 
     if (retorno == 0){
         printf("> O agendamento de reinicializacao/desligamento foi cancelado com sucesso!\n");
     } 
+    return retorno;
 }
 /*---------------------------------------------------------*/